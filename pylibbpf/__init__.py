@@ -1,11 +1,24 @@
 import logging
 
-from .ir_to_ctypes import convert_structs_to_ctypes, is_pythonbpf_structs
 from .pylibbpf import (
     BpfException,
     BpfMap,
     BpfProgram,
+    ColumnBatch,
+    EventBuffer,
+    EventFilter,
+    EventRecorder,
+    EventReplay,
+    EventSource,
+    EventView,
+    MapBuffer,
+    OverflowPolicy,
+    PercpuReduce,
     PerfEventArray,
+    PerfFlightRecorder,
+    Poller,
+    RingBuffer,
+    StructFormat,
     StructParser,
 )
 from .pylibbpf import (
@@ -16,29 +29,71 @@ from .wrappers import BpfObjectWrapper
 logger = logging.getLogger(__name__)
 
 
+def _convert_structs(structs):
+    if not structs:
+        return {}
+    # llvmlite is only needed for PythonBPF structs; plain objects are
+    # decoded from their BTF
+    from .ir_to_ctypes import convert_structs_to_ctypes, is_pythonbpf_structs
+
+    if is_pythonbpf_structs(structs):
+        logger.info(f"Auto-converting {len(structs)} PythonBPF structs to ctypes")
+        structs = convert_structs_to_ctypes(structs)
+    return structs
+
+
 class BpfObject(BpfObjectWrapper):
     """BpfObject with automatic struct conversion"""
 
     def __init__(self, object_path: str, structs=None):
         """Create a BPF object"""
-        if structs is None:
-            structs = {}
-        elif is_pythonbpf_structs(structs):
-            logger.info(f"Auto-converting {len(structs)} PythonBPF structs to ctypes")
-            structs = convert_structs_to_ctypes(structs)
-
         # Create C++ BpfObject with converted structs
-        cpp_obj = _BpfObject(object_path, structs)
+        cpp_obj = _BpfObject(object_path, _convert_structs(structs))
 
         # Initialize wrapper
         super().__init__(cpp_obj)
 
+    @classmethod
+    def from_bytes(cls, data, name: str = "", structs=None, cache: bool = False):
+        """Create a BPF object from an in-memory ELF image.
+
+        With cache=True identical images share one copy and repeat
+        instances start from an object parsed ahead of time.
+        """
+        cpp_obj = _BpfObject.from_bytes(data, name, _convert_structs(structs), cache)
+        obj = cls.__new__(cls)
+        BpfObjectWrapper.__init__(obj, cpp_obj)
+        return obj
+
+    @staticmethod
+    def clear_cache():
+        """Drop all cached object images"""
+        _BpfObject.clear_cache()
+
+    @staticmethod
+    def get_cache_stats():
+        return _BpfObject.get_cache_stats()
+
 
 __all__ = [
     "BpfObject",
     "BpfProgram",
     "BpfMap",
+    "ColumnBatch",
+    "EventBuffer",
+    "EventFilter",
+    "EventRecorder",
+    "EventReplay",
+    "EventSource",
+    "EventView",
+    "MapBuffer",
+    "OverflowPolicy",
     "PerfEventArray",
+    "PerfFlightRecorder",
+    "PercpuReduce",
+    "Poller",
+    "RingBuffer",
+    "StructFormat",
     "StructParser",
     "BpfException",
 ]
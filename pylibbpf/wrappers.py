@@ -1,7 +1,57 @@
+import asyncio
 from typing import Callable, Optional
 
 
-class PerfEventArrayHelper:
+class _AsyncConsumerMixin:
+    """asyncio integration through the consumer's epoll fd.
+
+    The loop wakes when a buffer becomes readable and the non-blocking
+    consume() runs inline, with no executor threads involved.
+    """
+
+    def _consumer(self):
+        raise NotImplementedError
+
+    @property
+    def source(self):
+        """The underlying consumer, for registering with a Poller."""
+        return self._consumer()
+
+    def fileno(self) -> int:
+        return self._consumer().fileno()
+
+    def add_reader(self, loop: Optional[asyncio.AbstractEventLoop] = None):
+        """Consume events from the loop's callbacks whenever data arrives."""
+        loop = loop or asyncio.get_running_loop()
+        consumer = self._consumer()
+        loop.add_reader(consumer.fileno(), consumer.consume)
+        return self
+
+    def remove_reader(self, loop: Optional[asyncio.AbstractEventLoop] = None):
+        loop = loop or asyncio.get_running_loop()
+        loop.remove_reader(self._consumer().fileno())
+        return self
+
+    async def stream(self):
+        """Await readiness, consume, and yield consume()'s result."""
+        loop = asyncio.get_running_loop()
+        consumer = self._consumer()
+        fd = consumer.fileno()
+        ready = asyncio.Event()
+        loop.add_reader(fd, ready.set)
+        try:
+            while True:
+                await ready.wait()
+                ready.clear()
+                yield consumer.consume()
+        finally:
+            loop.remove_reader(fd)
+
+    def __aiter__(self):
+        return self.stream()
+
+
+class PerfEventArrayHelper(_AsyncConsumerMixin):
     """Fluent wrapper for PERF_EVENT_ARRAY maps."""
 
     def __init__(self, bpf_map):
@@ -14,8 +64,21 @@ class PerfEventArrayHelper:
         struct_name: str = "",
         page_cnt: int = 8,
         lost_callback: Optional[Callable] = None,
+        max_batch_size: int = 0,
+        flush_latency_ms: int = 0,
+        columnar: bool = False,
+        event_filter=None,
+        recorder=None,
     ):
-        """Open perf buffer with auto-deserialization."""
+        """Open perf buffer with auto-deserialization.
+
+        With max_batch_size > 0 the callback receives a list of
+        (cpu, event) tuples per batch instead of one call per event.
+        With columnar=True it receives a ColumnBatch of per-field arrays.
+        An EventFilter drops events natively before they reach Python.
+        An EventRecorder captures raw samples to disk instead of calling
+        the callback.
+        """
         from .pylibbpf import PerfEventArray
 
         if struct_name:
@@ -31,8 +94,26 @@ class PerfEventArrayHelper:
                 self._map, page_cnt, callback, lost_callback or (lambda cpu, cnt: None)
             )
 
+        if max_batch_size:
+            self._perf_buffer.set_batching(max_batch_size, flush_latency_ms)
+        if columnar:
+            self._perf_buffer.set_columnar()
+        if event_filter is not None:
+            self._perf_buffer.set_filter(event_filter)
+        if recorder is not None:
+            self._perf_buffer.set_recorder(recorder)
+
         return self
 
+    def open_flight_recorder(self, struct_name: str = "", page_cnt: int = 64):
+        """Keep the newest events in overwritable kernel rings.
+
+        Nothing is read until snapshot() is called on the returned recorder.
+        """
+        from .pylibbpf import PerfFlightRecorder
+
+        return PerfFlightRecorder(self._map, page_cnt, struct_name)
+
     def poll(self, timeout_ms: int = -1) -> int:
         if not self._perf_buffer:
             raise RuntimeError("Call open_perf_buffer() first")
@@ -43,6 +124,56 @@ class PerfEventArrayHelper:
             raise RuntimeError("Call open_perf_buffer() first")
         return self._perf_buffer.consume()
 
+    def _consumer(self):
+        if not self._perf_buffer:
+            raise RuntimeError("Call open_perf_buffer() first")
+        return self._perf_buffer
+
+    def __getattr__(self, name):
+        return getattr(self._map, name)
+
+
+class RingBufferHelper(_AsyncConsumerMixin):
+    """Fluent wrapper for RINGBUF maps."""
+
+    def __init__(self, bpf_map):
+        self._map = bpf_map
+        self._ring_buffer = None
+
+    def open_ring_buffer(
+        self, callback: Callable, struct_name: str = "", event_filter=None
+    ):
+        """Open ring buffer with auto-deserialization."""
+        from .pylibbpf import RingBuffer
+
+        self._ring_buffer = RingBuffer(self._map, callback, struct_name)
+        if event_filter is not None:
+            self._ring_buffer.set_filter(event_filter, self._map)
+        return self
+
+    def add(self, other, callback: Callable, struct_name: str = ""):
+        """Service another ring buffer map from this helper's poll()."""
+        if not self._ring_buffer:
+            raise RuntimeError("Call open_ring_buffer() first")
+        other_map = other._map if isinstance(other, RingBufferHelper) else other
+        self._ring_buffer.add(other_map, callback, struct_name)
+        return self
+
+    def poll(self, timeout_ms: int = -1) -> int:
+        if not self._ring_buffer:
+            raise RuntimeError("Call open_ring_buffer() first")
+        return self._ring_buffer.poll(timeout_ms)
+
+    def consume(self) -> int:
+        if not self._ring_buffer:
+            raise RuntimeError("Call open_ring_buffer() first")
+        return self._ring_buffer.consume()
+
+    def _consumer(self):
+        if not self._ring_buffer:
+            raise RuntimeError("Call open_ring_buffer() first")
+        return self._ring_buffer
+
     def __getattr__(self, name):
         return getattr(self._map, name)
 
@@ -67,6 +198,8 @@ class BpfObjectWrapper:
 
         if map_type == self.BPF_MAP_TYPE_PERF_EVENT_ARRAY:
             helper = PerfEventArrayHelper(map_obj)
+        elif map_type == self.BPF_MAP_TYPE_RINGBUF:
+            helper = RingBufferHelper(map_obj)
         else:
             helper = map_obj
 
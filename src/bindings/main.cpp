@@ -4,11 +4,27 @@
 
 #include "core/bpf_exception.h"
 #include "core/bpf_map.h"
+#include "core/bpf_map_iterator.h"
 #include "core/bpf_object.h"
 #include "core/bpf_program.h"
+#include "maps/event_source.h"
 #include "maps/perf_event_array.h"
+#include "maps/perf_flight_recorder.h"
+#include "maps/poller.h"
+#include "maps/ring_buffer.h"
+#include "utils/column_batch.h"
+#include "utils/event_filter.h"
+#include "utils/event_queue.h"
+#include "utils/event_recorder.h"
+#include "utils/event_view.h"
+#include "utils/map_buffer.h"
+#include "utils/mmap_region.h"
 #include "utils/struct_parser.h"
 
+#ifdef PYLIBBPF_TESTING
+#include "bindings/testing.h"
+#endif
+
 namespace py = pybind11;
 
 PYBIND11_MODULE(pylibbpf, m) {
@@ -33,14 +49,40 @@ PYBIND11_MODULE(pylibbpf, m) {
   py::class_<BpfObject, std::shared_ptr<BpfObject>>(m, "BpfObject")
       .def(py::init<std::string, py::dict>(), py::arg("object_path"),
            py::arg("structs") = py::dict())
+      .def_static("from_bytes", &BpfObject::from_bytes, py::arg("data"),
+                  py::arg("name") = "", py::arg("structs") = py::dict(),
+                  py::arg("cache") = false)
+      .def_static("clear_cache", &BpfObject::clear_cache)
+      .def_static("get_cache_stats", &BpfObject::get_cache_stats)
+      .def("open", &BpfObject::open)
       .def("load", &BpfObject::load)
+      .def("is_opened", &BpfObject::is_opened)
       .def("is_loaded", &BpfObject::is_loaded)
+      .def("set_max_entries", &BpfObject::set_max_entries, py::arg("map_name"),
+           py::arg("max_entries"))
+      .def("set_autoload", &BpfObject::set_autoload, py::arg("prog_name"),
+           py::arg("autoload"))
+      .def("set_pin_path", &BpfObject::set_pin_path, py::arg("map_name"),
+           py::arg("path"))
+      .def("set_pin_root", &BpfObject::set_pin_root, py::arg("dir"))
+      .def("reuse_map", &BpfObject::reuse_map, py::arg("map_name"),
+           py::arg("source"))
+      .def("set_multi_attach", &BpfObject::set_multi_attach,
+           py::arg("enable"))
+      .def("set_decode_structs", &BpfObject::set_decode_structs,
+           py::arg("names"))
+      .def("set_global", &BpfObject::set_global, py::arg("name"),
+           py::arg("value"))
+      .def("get_global", &BpfObject::get_global, py::arg("name"))
       .def("get_program_names", &BpfObject::get_program_names)
       .def("get_program", &BpfObject::get_program, py::arg("name"))
       .def("attach_all", &BpfObject::attach_all)
+      .def("attach_all_parallel", &BpfObject::attach_all_parallel,
+           py::arg("max_threads") = 0)
       .def("get_map_names", &BpfObject::get_map_names)
       .def("get_map", &BpfObject::get_map, py::arg("name"))
       .def("get_struct_defs", &BpfObject::get_struct_defs)
+      .def("get_struct_parser", &BpfObject::get_struct_parser)
       .def("__getitem__", &BpfObject::get_map, py::arg("name"));
 
   // BpfProgram
@@ -48,37 +90,188 @@ PYBIND11_MODULE(pylibbpf, m) {
       .def("attach", &BpfProgram::attach)
       .def("detach", &BpfProgram::detach)
       .def("is_attached", &BpfProgram::is_attached)
+      .def("pin_link", &BpfProgram::pin_link, py::arg("path"))
+      .def("unpin_link", &BpfProgram::unpin_link)
+      .def("adopt_link", &BpfProgram::adopt_link, py::arg("path"),
+           py::arg("replace") = false)
+      .def("is_link_pinned", &BpfProgram::is_link_pinned)
       .def("get_name", &BpfProgram::get_name);
 
   // BpfMap
-  py::class_<BpfMap, std::shared_ptr<BpfMap>>(m, "BpfMap")
+  py::class_<BpfMap, std::shared_ptr<BpfMap>> bpf_map(m, "BpfMap");
+
+  py::enum_<BpfMap::PercpuReduce>(m, "PercpuReduce")
+      .value("SUM", BpfMap::PercpuReduce::Sum)
+      .value("MIN", BpfMap::PercpuReduce::Min)
+      .value("MAX", BpfMap::PercpuReduce::Max);
+
+  bpf_map
       .def("lookup", &BpfMap::lookup, py::arg("key"))
       .def("update", &BpfMap::update, py::arg("key"), py::arg("value"))
       .def("delete_elem", &BpfMap::delete_elem, py::arg("key"))
       .def("get_next_key", &BpfMap::get_next_key, py::arg("key") = py::none())
-      .def("items", &BpfMap::items)
-      .def("keys", &BpfMap::keys)
-      .def("values", &BpfMap::values)
+      .def("items", &BpfMap::items,
+           py::arg("chunk_size") = BpfMap::kDefaultBatchSize)
+      .def("keys", &BpfMap::keys,
+           py::arg("chunk_size") = BpfMap::kDefaultBatchSize)
+      .def("values", &BpfMap::values,
+           py::arg("chunk_size") = BpfMap::kDefaultBatchSize)
+      .def("iter_items", &BpfMap::iter_items,
+           py::arg("chunk_size") = BpfMap::kDefaultBatchSize)
+      .def("iter_keys", &BpfMap::iter_keys,
+           py::arg("chunk_size") = BpfMap::kDefaultBatchSize)
+      .def("iter_values", &BpfMap::iter_values,
+           py::arg("chunk_size") = BpfMap::kDefaultBatchSize)
+      .def("lookup_batch", &BpfMap::lookup_batch,
+           py::arg("in_batch") = py::none(),
+           py::arg("count") = BpfMap::kDefaultBatchSize)
+      .def("update_batch", &BpfMap::update_batch, py::arg("keys"),
+           py::arg("values"), py::arg("flags") = BPF_ANY)
+      .def("delete_batch", &BpfMap::delete_batch, py::arg("keys"))
+      .def("drain", &BpfMap::drain,
+           py::arg("chunk_size") = BpfMap::kDefaultBatchSize)
       .def("get_name", &BpfMap::get_name)
       .def("get_fd", &BpfMap::get_fd)
       .def("get_type", &BpfMap::get_type)
       .def("get_key_size", &BpfMap::get_key_size)
       .def("get_value_size", &BpfMap::get_value_size)
       .def("get_max_entries", &BpfMap::get_max_entries)
+      .def("lookup_reduce", &BpfMap::lookup_reduce, py::arg("key"),
+           py::arg("op") = BpfMap::PercpuReduce::Sum)
+      .def("items_reduce", &BpfMap::items_reduce,
+           py::arg("op") = BpfMap::PercpuReduce::Sum,
+           py::arg("chunk_size") = BpfMap::kDefaultBatchSize)
+      .def("export_buffers", &BpfMap::export_buffers,
+           py::arg("chunk_size") = BpfMap::kDefaultBatchSize)
+      .def("lookup_into", &BpfMap::lookup_into, py::arg("key"),
+           py::arg("out"))
+      .def("update_from", &BpfMap::update_from, py::arg("key"),
+           py::arg("value"), py::arg("flags") = BPF_ANY)
+      .def("lookup_many", &BpfMap::lookup_many, py::arg("keys"))
+      .def("update_many", &BpfMap::update_many, py::arg("keys"),
+           py::arg("values"), py::arg("flags") = BPF_ANY)
+      .def("mmap", &BpfMap::mmap)
+      .def("is_mmapable", &BpfMap::is_mmapable)
+      .def("is_percpu", &BpfMap::is_percpu)
+      .def("get_num_cpus", &BpfMap::get_num_cpus)
+      .def("pin", &BpfMap::pin, py::arg("path"))
+      .def("unpin", &BpfMap::unpin, py::arg("path") = "")
+      .def("is_pinned", &BpfMap::is_pinned)
+      .def("get_pin_path", &BpfMap::get_pin_path)
+      .def("has_btf_key", &BpfMap::has_btf_key)
+      .def("has_btf_value", &BpfMap::has_btf_value)
+      .def_property("struct_format", &BpfMap::get_struct_format,
+                    &BpfMap::set_struct_format)
+      .def("__iter__", &BpfMap::iter_keys,
+           py::arg("chunk_size") = BpfMap::kDefaultBatchSize)
       .def("__getitem__", &BpfMap::lookup, py::arg("key"))
       .def("__setitem__", &BpfMap::update, py::arg("key"), py::arg("value"))
       .def("__delitem__", &BpfMap::delete_elem, py::arg("key"));
 
+  py::class_<BpfMapIterator, std::shared_ptr<BpfMapIterator>>(
+      m, "BpfMapIterator")
+      .def("__iter__", &BpfMapIterator::iter,
+           py::return_value_policy::reference_internal)
+      .def("__next__", &BpfMapIterator::next);
+
+  // MapBuffer
+  py::class_<MapBuffer, std::shared_ptr<MapBuffer>>(m, "MapBuffer",
+                                                    py::buffer_protocol())
+      .def_buffer(&MapBuffer::buffer_info)
+      .def("__len__", &MapBuffer::size)
+      .def_property_readonly("nbytes", &MapBuffer::nbytes)
+      .def_property_readonly("format", &MapBuffer::get_format);
+
+  // EventFilter
+  py::class_<EventFilter, std::shared_ptr<EventFilter>>(m, "EventFilter")
+      .def(py::init<>())
+      .def("where", &EventFilter::where, py::arg("field"), py::arg("op"),
+           py::arg("value"), py::return_value_policy::reference_internal)
+      .def("sample", &EventFilter::sample, py::arg("every_n"),
+           py::return_value_policy::reference_internal)
+      .def("rate_limit", &EventFilter::rate_limit, py::arg("events_per_sec"),
+           py::arg("burst") = 0, py::return_value_policy::reference_internal)
+      .def("get_stats", &EventFilter::get_stats);
+
+  // EventRecorder / EventReplay
+  py::class_<EventRecorder, std::shared_ptr<EventRecorder>>(m, "EventRecorder")
+      .def(py::init<std::string, size_t, size_t>(), py::arg("path"),
+           py::arg("segment_size") = 256 << 20,
+           py::arg("buffer_size") = 1 << 20)
+      .def("flush", &EventRecorder::flush,
+           py::call_guard<py::gil_scoped_release>())
+      .def("close", &EventRecorder::close,
+           py::call_guard<py::gil_scoped_release>())
+      .def("get_stats", &EventRecorder::get_stats);
+
+  py::class_<EventReplay, std::shared_ptr<EventReplay>>(m, "EventReplay")
+      .def(py::init<std::string>(), py::arg("path"))
+      .def("replay", &EventReplay::replay, py::arg("callback"),
+           py::arg("struct_name") = "", py::arg("parser") = py::none(),
+           py::arg("max_events") = 0)
+      .def("read", &EventReplay::read, py::arg("max_events") = 0)
+      .def("get_num_segments", &EventReplay::get_num_segments);
+
+  // ColumnBatch
+  py::class_<ColumnBatch, std::shared_ptr<ColumnBatch>>(m, "ColumnBatch")
+      .def("__len__", &ColumnBatch::size)
+      .def("__getitem__", &ColumnBatch::column, py::arg("name"))
+      .def("__contains__", &ColumnBatch::has_column, py::arg("name"))
+      .def_property_readonly("columns", &ColumnBatch::get_columns)
+      .def_property_readonly("cpus", &ColumnBatch::cpus)
+      .def("to_dict", &ColumnBatch::to_dict);
+
+  // MmapRegion
+  py::class_<MmapRegion, std::shared_ptr<MmapRegion>>(m, "MmapRegion",
+                                                      py::buffer_protocol())
+      .def_buffer(&MmapRegion::buffer_info)
+      .def("is_readonly", &MmapRegion::is_readonly)
+      .def("__len__", &MmapRegion::size);
+
   // StructParser
-  py::class_<StructParser>(m, "StructParser")
+  py::enum_<StructFormat>(m, "StructFormat")
+      .value("NAMEDTUPLE", StructFormat::NamedTuple)
+      .value("DICT", StructFormat::Dict)
+      .value("TUPLE", StructFormat::Tuple);
+
+  py::class_<StructParser, std::shared_ptr<StructParser>>(m, "StructParser")
       .def(py::init<py::dict>(), py::arg("structs"))
       .def("parse", &StructParser::parse, py::arg("struct_name"),
            py::arg("data"))
-      .def("has_struct", &StructParser::has_struct, py::arg("struct_name"));
+      .def("has_struct", &StructParser::has_struct, py::arg("struct_name"))
+      .def_property("format", &StructParser::get_format,
+                    &StructParser::set_format);
+
+  // EventView
+  py::class_<EventBuffer, std::shared_ptr<EventBuffer>>(m, "EventBuffer",
+                                                        py::buffer_protocol())
+      .def_buffer(&EventBuffer::buffer_info)
+      .def("__len__", &EventBuffer::size);
+
+  py::class_<EventView, std::shared_ptr<EventView>>(m, "EventView")
+      .def("memoryview", &EventView::memoryview)
+      .def("as_struct", &EventView::as_struct)
+      .def("copy", &EventView::copy)
+      .def("tobytes", &EventView::tobytes)
+      .def("is_valid", &EventView::is_valid)
+      .def("__bytes__", &EventView::tobytes)
+      .def("__len__", &EventView::size)
+      .def("__getattr__", &EventView::getattr, py::arg("name"));
+
+  py::enum_<OverflowPolicy>(m, "OverflowPolicy")
+      .value("DROP_OLDEST", OverflowPolicy::DropOldest)
+      .value("DROP_NEWEST", OverflowPolicy::DropNewest)
+      .value("BLOCK", OverflowPolicy::Block);
+
+  // EventSource
+  py::class_<EventSource, std::shared_ptr<EventSource>>(m, "EventSource")
+      .def("epoll_fd", &EventSource::epoll_fd)
+      .def("consume_budget", &EventSource::consume_budget, py::arg("budget"),
+           py::call_guard<py::gil_scoped_release>());
 
   // PerfEventArray
-  py::class_<PerfEventArray, std::shared_ptr<PerfEventArray>>(m,
-                                                              "PerfEventArray")
+  py::class_<PerfEventArray, EventSource, std::shared_ptr<PerfEventArray>>(
+      m, "PerfEventArray")
       .def(py::init<std::shared_ptr<BpfMap>, int, py::function, py::object>(),
            py::arg("map"), py::arg("page_cnt"), py::arg("callback"),
            py::arg("lost_callback") = py::none())
@@ -88,8 +281,74 @@ PYBIND11_MODULE(pylibbpf, m) {
            py::arg("struct_name"), py::arg("lost_callback") = py::none())
       .def("poll", &PerfEventArray::poll, py::arg("timeout_ms"))
       .def("consume", &PerfEventArray::consume)
+      .def("epoll_fd", &PerfEventArray::epoll_fd)
+      .def("fileno", &PerfEventArray::epoll_fd)
+      .def("set_batching", &PerfEventArray::set_batching,
+           py::arg("max_batch_size"), py::arg("flush_latency_ms") = 0)
+      .def("set_columnar", &PerfEventArray::set_columnar,
+           py::arg("enabled") = true)
+      .def("set_filter", &PerfEventArray::set_filter, py::arg("filter"))
+      .def("set_recorder", &PerfEventArray::set_recorder,
+           py::arg("recorder"), py::arg("deliver") = false)
+      .def("set_zero_copy", &PerfEventArray::set_zero_copy,
+           py::arg("enabled") = true)
+      .def("start_workers", &PerfEventArray::start_workers,
+           py::arg("num_threads") = 1, py::arg("queue_capacity") = 65536,
+           py::arg("policy") = OverflowPolicy::DropOldest,
+           py::arg("slot_size") = EventQueue::kDefaultSlotSize)
+      .def("stop_workers", &PerfEventArray::stop_workers)
+      .def("read_events", &PerfEventArray::read_events,
+           py::arg("max_events") = 1024, py::arg("timeout_ms") = -1)
+      .def("get_queue_stats", &PerfEventArray::get_queue_stats)
+      .def("stats", &PerfEventArray::stats)
+      .def("reset_stats", &PerfEventArray::reset_stats)
       .def("get_map", &PerfEventArray::get_map);
 
+  // PerfFlightRecorder
+  py::class_<PerfFlightRecorder, std::shared_ptr<PerfFlightRecorder>>(
+      m, "PerfFlightRecorder")
+      .def(py::init<std::shared_ptr<BpfMap>, int, std::string>(),
+           py::arg("map"), py::arg("page_cnt") = 64,
+           py::arg("struct_name") = "")
+      .def("snapshot", &PerfFlightRecorder::snapshot,
+           py::arg("max_events_per_cpu") = 0)
+      .def("get_num_rings", &PerfFlightRecorder::get_num_rings)
+      .def("get_map", &PerfFlightRecorder::get_map);
+
+  // RingBuffer
+  py::class_<RingBuffer, EventSource, std::shared_ptr<RingBuffer>>(
+      m, "RingBuffer")
+      .def(py::init<std::shared_ptr<BpfMap>, py::function, std::string>(),
+           py::arg("map"), py::arg("callback"), py::arg("struct_name") = "")
+      .def("add", &RingBuffer::add, py::arg("map"), py::arg("callback"),
+           py::arg("struct_name") = "")
+      .def("poll", &RingBuffer::poll, py::arg("timeout_ms"))
+      .def("consume", &RingBuffer::consume)
+      .def("epoll_fd", &RingBuffer::epoll_fd)
+      .def("fileno", &RingBuffer::epoll_fd)
+      .def("set_filter", &RingBuffer::set_filter, py::arg("filter"),
+           py::arg("map") = py::none())
+      .def("set_zero_copy", &RingBuffer::set_zero_copy,
+           py::arg("enabled") = true)
+      .def("get_maps", &RingBuffer::get_maps);
+
+  // Poller
+  py::class_<Poller, std::shared_ptr<Poller>>(m, "Poller")
+      .def(py::init<>())
+      .def("add", &Poller::add, py::arg("source"), py::arg("priority") = 0,
+           py::arg("budget") = 0)
+      .def("remove", &Poller::remove, py::arg("source"))
+      .def("poll", &Poller::poll, py::arg("timeout_ms") = -1)
+      .def("epoll_fd", &Poller::epoll_fd)
+      .def("fileno", &Poller::epoll_fd)
+      .def("__len__", &Poller::size);
+
+#ifdef PYLIBBPF_TESTING
+  // Hooks for the test suite; not part of the public API
+  auto testing = m.def_submodule("_testing");
+  register_testing(testing);
+#endif
+
 #ifdef VERSION_INFO
   m.attr("__version__") = MACRO_STRINGIFY(VERSION_INFO);
 #else
@@ -0,0 +1,312 @@
+#include "bindings/testing.h"
+#include "core/bpf_exception.h"
+#include "core/bpf_map.h"
+#include "core/bpf_object.h"
+#include "utils/btf_codec.h"
+#include "utils/column_batch.h"
+#include "utils/consumer_stats.h"
+#include "utils/event_filter.h"
+#include "utils/event_queue.h"
+#include "utils/event_recorder.h"
+#include "utils/event_view.h"
+#include "utils/struct_parser.h"
+#include <algorithm>
+#include <btf.h>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+std::string_view bytes_view(const py::bytes &data) {
+  char *ptr = nullptr;
+  Py_ssize_t len = 0;
+  if (PyBytes_AsStringAndSize(data.ptr(), &ptr, &len) < 0) {
+    throw py::error_already_set();
+  }
+  return {ptr, static_cast<size_t>(len)};
+}
+
+/**
+ * TestBtf - BTF built in memory, so codec, layout and filter tests do not
+ * need a compiled BPF object.
+ */
+class TestBtf {
+private:
+  struct btf *btf_;
+  int index_type_ = 0;
+
+  static int check(int id, const std::string &what) {
+    if (id < 0) {
+      throw BpfException("Failed to add BTF " + what + ": " +
+                         std::strerror(-id));
+    }
+    return id;
+  }
+
+  std::shared_ptr<BtfCodec> codec(const std::string &name) const {
+    auto codec = BtfCodec::for_name(btf_, name);
+    if (!codec) {
+      throw BpfException("Unknown struct: " + name);
+    }
+    return codec;
+  }
+
+public:
+  TestBtf() : btf_(btf__new_empty()) {
+    if (!btf_) {
+      throw BpfException(std::string("Failed to create BTF: ") +
+                         std::strerror(errno));
+    }
+  }
+
+  ~TestBtf() { btf__free(btf_); }
+
+  TestBtf(const TestBtf &) = delete;
+  TestBtf &operator=(const TestBtf &) = delete;
+
+  int add_int(const std::string &name, size_t size, bool is_signed,
+              bool is_char) {
+    int encoding = (is_signed ? BTF_INT_SIGNED : 0) |
+                   (is_char ? BTF_INT_CHAR : 0);
+    return check(btf__add_int(btf_, name.c_str(), size, encoding),
+                 "int '" + name + "'");
+  }
+
+  int add_array(int elem_type, __u32 count) {
+    if (!index_type_) {
+      index_type_ = add_int("unsigned int", 4, false, false);
+    }
+    return check(btf__add_array(btf_, index_type_, elem_type, count),
+                 "array");
+  }
+
+  // fields: (name, type_id, bit_offset[, bitfield_size]) tuples
+  int add_struct(const std::string &name, __u32 size, py::list fields) {
+    int id = check(btf__add_struct(btf_, name.c_str(), size),
+                   "struct '" + name + "'");
+    for (auto item : fields) {
+      auto field = item.cast<py::tuple>();
+      auto field_name = field[0].cast<std::string>();
+      __u32 bitfield_size = field.size() > 3 ? field[3].cast<__u32>() : 0;
+      check(btf__add_field(btf_, field_name.c_str(), field[1].cast<int>(),
+                           field[2].cast<__u32>(), bitfield_size),
+            "field '" + field_name + "'");
+    }
+    return id;
+  }
+
+  py::object decode(const std::string &name, const py::bytes &data,
+                    StructFormat format, bool text) const {
+    auto raw = bytes_view(data);
+    return codec(name)->decode(raw.data(), raw.size(), format, text);
+  }
+
+  py::bytes encode(const std::string &name, py::handle obj) const {
+    auto struct_codec = codec(name);
+    std::string out(struct_codec->size(), '\0');
+    struct_codec->encode(obj, out.data(), out.size());
+    return py::bytes(out);
+  }
+
+  py::list columns(const std::string &name) const {
+    ColumnLayout layout(*codec(name));
+    py::list names;
+    for (const auto &column : layout.columns()) {
+      names.append(column.name);
+    }
+    return names;
+  }
+
+  bool admit(EventFilter &filter, const std::string &name,
+             const py::bytes &data) const {
+    ColumnLayout layout(*codec(name));
+    auto predicate = filter.bind(&layout);
+    auto raw = bytes_view(data);
+    return filter.admit(*predicate, raw.data(), raw.size());
+  }
+
+  [[nodiscard]] std::shared_ptr<StructParser> parser() const {
+    return std::make_shared<StructParser>(py::dict(), btf_);
+  }
+};
+
+/**
+ * TestSample - Stands in for ring memory behind an EventView. release()
+ * scribbles over the sample, the way the kernel reuses a consumed record.
+ */
+class TestSample {
+private:
+  std::vector<uint8_t> data_;
+  std::shared_ptr<EventView> view_;
+
+public:
+  std::shared_ptr<EventView> view(const py::bytes &data,
+                                  std::shared_ptr<StructParser> parser,
+                                  const std::string &struct_name) {
+    release();
+    auto raw = bytes_view(data);
+    data_.assign(raw.begin(), raw.end());
+    view_ = std::make_shared<EventView>(data_.data(), data_.size(),
+                                        std::move(parser), struct_name);
+    return view_;
+  }
+
+  void release() {
+    if (view_) {
+      view_->release();
+      view_.reset();
+    }
+    std::fill(data_.begin(), data_.end(), 0xff);
+  }
+};
+
+bool admit_raw(EventFilter &filter, const py::bytes &data) {
+  auto predicate = filter.bind(static_cast<const ColumnLayout *>(nullptr));
+  auto raw = bytes_view(data);
+  return filter.admit(*predicate, raw.data(), raw.size());
+}
+
+void record(EventRecorder &recorder, int cpu, const py::bytes &data) {
+  auto raw = bytes_view(data);
+  recorder.append(cpu, raw.data(), raw.size());
+}
+
+// Reshape an opened object's map so one test object can stand in for
+// every map type; libbpf refuses (-EBUSY) once the object is loaded
+void set_map_def(const BpfObject &obj, const std::string &name, int type,
+                 __u32 key_size, __u32 value_size, __u32 max_entries) {
+  struct bpf_map *map = obj.find_map_by_name(name);
+  for (int err : {bpf_map__set_type(map, static_cast<bpf_map_type>(type)),
+                  bpf_map__set_key_size(map, key_size),
+                  bpf_map__set_value_size(map, value_size),
+                  bpf_map__set_max_entries(map, max_entries)}) {
+    if (err) {
+      throw BpfException("Failed to reshape map '" + name +
+                         "': " + std::strerror(-err));
+    }
+  }
+}
+
+// Walk (or drain) a map with the batched syscalls disabled, as on pre-5.6
+// kernels
+py::list dump_per_key(const BpfMap &map, size_t max_entries, bool drain) {
+  const size_t key_size = map.get_key_size();
+  const size_t value_size = map.get_value_size();
+  std::vector<uint8_t> keys(key_size * max_entries);
+  std::vector<uint8_t> values(value_size * max_entries);
+
+  BpfMap::DumpCursor cursor;
+  cursor.per_key = true;
+  cursor.drain = drain;
+  py::list entries;
+  while (!cursor.done) {
+    size_t n = map.dump_chunk(cursor, keys, values, max_entries);
+    for (size_t i = 0; i < n; ++i) {
+      entries.append(py::make_tuple(
+          py::bytes(reinterpret_cast<const char *>(&keys[i * key_size]),
+                    key_size),
+          py::bytes(reinterpret_cast<const char *>(&values[i * value_size]),
+                    value_size)));
+    }
+  }
+  return entries;
+}
+
+// The bytes object outlives the call, so it can be read without the GIL
+bool queue_push(EventQueue &queue, int cpu, const py::bytes &data) {
+  auto raw = bytes_view(data);
+  py::gil_scoped_release release;
+  return queue.push(cpu, raw.data(), raw.size());
+}
+
+py::object queue_pop(EventQueue &queue, int timeout_ms) {
+  QueuedEvent event;
+  bool popped;
+  {
+    py::gil_scoped_release release;
+    popped = queue.pop_wait(event, std::chrono::milliseconds(timeout_ms));
+  }
+  if (!popped) {
+    return py::none();
+  }
+  return py::make_tuple(
+      event.cpu, py::bytes(reinterpret_cast<const char *>(event.data.data()),
+                           event.data.size()));
+}
+
+py::dict queue_stats(const EventQueue &queue) {
+  py::dict stats;
+  stats["enqueued"] = queue.enqueued();
+  stats["dropped_oldest"] = queue.dropped_oldest();
+  stats["dropped_newest"] = queue.dropped_newest();
+  stats["blocked"] = queue.blocked();
+  return stats;
+}
+
+} // namespace
+
+void register_testing(py::module_ &m) {
+  py::class_<TestBtf, std::shared_ptr<TestBtf>>(m, "Btf")
+      .def(py::init<>())
+      .def("add_int", &TestBtf::add_int, py::arg("name"), py::arg("size"),
+           py::arg("signed") = false, py::arg("char") = false)
+      .def("add_array", &TestBtf::add_array, py::arg("elem_type"),
+           py::arg("count"))
+      .def("add_struct", &TestBtf::add_struct, py::arg("name"),
+           py::arg("size"), py::arg("fields"))
+      .def("decode", &TestBtf::decode, py::arg("name"), py::arg("data"),
+           py::arg("format") = StructFormat::Dict, py::arg("text") = false)
+      .def("encode", &TestBtf::encode, py::arg("name"), py::arg("obj"))
+      .def("columns", &TestBtf::columns, py::arg("name"))
+      .def("admit", &TestBtf::admit, py::arg("filter"), py::arg("name"),
+           py::arg("data"))
+      .def("parser", &TestBtf::parser, py::keep_alive<0, 1>());
+
+  py::class_<TestSample, std::shared_ptr<TestSample>>(m, "Sample")
+      .def(py::init<>())
+      .def("view", &TestSample::view, py::arg("data"),
+           py::arg("parser") = nullptr, py::arg("struct_name") = "")
+      .def("release", &TestSample::release);
+
+  m.def("admit_raw", &admit_raw, py::arg("filter"), py::arg("data"));
+  m.def("record", &record, py::arg("recorder"), py::arg("cpu"),
+        py::arg("data"));
+
+  m.def("set_map_def", &set_map_def, py::arg("obj"), py::arg("name"),
+        py::arg("type"), py::arg("key_size"), py::arg("value_size"),
+        py::arg("max_entries"));
+  m.def("dump_per_key", &dump_per_key, py::arg("map"),
+        py::arg("max_entries") = 4, py::arg("drain") = false);
+
+  py::class_<ConsumerStats, std::shared_ptr<ConsumerStats>>(m,
+                                                            "ConsumerStats")
+      .def(py::init<int>(), py::arg("num_cpus"))
+      .def("record_sample", &ConsumerStats::record_sample, py::arg("cpu"),
+           py::arg("bytes"))
+      .def("record_lost", &ConsumerStats::record_lost, py::arg("cpu"),
+           py::arg("count"))
+      .def("record_poll", &ConsumerStats::record_poll, py::arg("ns"))
+      .def("record_decode", &ConsumerStats::record_decode, py::arg("ns"))
+      .def("record_callback", &ConsumerStats::record_callback,
+           py::arg("gil_wait_ns"), py::arg("callback_ns"))
+      .def("snapshot", &ConsumerStats::snapshot)
+      .def("reset", &ConsumerStats::reset);
+
+  py::class_<EventQueue, std::shared_ptr<EventQueue>>(m, "EventQueue")
+      .def(py::init<size_t, OverflowPolicy, size_t>(), py::arg("capacity"),
+           py::arg("policy"),
+           py::arg("slot_size") = EventQueue::kDefaultSlotSize)
+      .def("push", &queue_push, py::arg("cpu"), py::arg("data"))
+      .def("pop", &queue_pop, py::arg("timeout_ms") = 0)
+      .def("close", &EventQueue::close)
+      .def("get_stats", &queue_stats)
+      .def("__len__", &EventQueue::size)
+      .def_property_readonly("capacity", &EventQueue::capacity)
+      .def_property_readonly("slot_size", &EventQueue::slot_size);
+}
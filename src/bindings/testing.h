@@ -0,0 +1,15 @@
+#ifndef PYLIBBPF_TESTING_H
+#define PYLIBBPF_TESTING_H
+
+#include <pybind11/pybind11.h>
+
+namespace py = pybind11;
+
+/**
+ * Register the private `_testing` submodule: thin hooks that let the test
+ * suite drive native pieces (queue, codec, filter, recorder, views, stats,
+ * map dumps) that have no public binding of their own.
+ */
+void register_testing(py::module_ &m);
+
+#endif // PYLIBBPF_TESTING_H
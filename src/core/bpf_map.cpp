@@ -1,14 +1,39 @@
 #include "core/bpf_map.h"
 #include "core/bpf_exception.h"
+#include "core/bpf_map_iterator.h"
 #include "core/bpf_object.h"
+#include "utils/map_buffer.h"
+#include "utils/mmap_region.h"
 #include <algorithm>
 #include <cerrno>
 #include <cstring>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace {
+
+std::shared_ptr<const BtfCodec> make_codec(const struct btf *btf, __u32 type_id,
+                                           __u32 size) {
+  if (!btf || type_id == 0)
+    return nullptr;
+  try {
+    auto codec = std::make_shared<const BtfCodec>(btf, type_id);
+    if (codec->size() == size)
+      return codec;
+  } catch (const BpfException &) {
+    // Types the codec cannot describe keep the size-based conversion
+  }
+  return nullptr;
+}
+
+} // namespace
 
 BpfMap::BpfMap(std::shared_ptr<BpfObject> parent, struct bpf_map *raw_map,
                const std::string &map_name)
     : parent_obj_(parent), map_(raw_map), map_fd_(-1), map_name_(map_name),
-      key_size_(0), value_size_(0) {
+      key_size_(0), value_size_(0), percpu_(false), num_cpus_(1),
+      value_stride_(0), value_buf_size_(0),
+      struct_format_(StructFormat::NamedTuple), scratch_leased_(false) {
   if (!parent)
     throw BpfException("Parent BpfObject is null");
   if (!(parent->is_loaded()))
@@ -23,23 +48,75 @@ BpfMap::BpfMap(std::shared_ptr<BpfObject> parent, struct bpf_map *raw_map,
 
   key_size_ = bpf_map__key_size(map_);
   value_size_ = bpf_map__value_size(map_);
+  value_stride_ = value_size_;
+  value_buf_size_ = value_size_;
+
+  const struct btf *btf = bpf_object__btf(parent->get_obj());
+  key_codec_ = make_codec(btf, bpf_map__btf_key_type_id(map_), key_size_);
+  value_codec_ =
+      make_codec(btf, bpf_map__btf_value_type_id(map_), value_size_);
+
+  switch (bpf_map__type(map_)) {
+  case BPF_MAP_TYPE_PERCPU_HASH:
+  case BPF_MAP_TYPE_PERCPU_ARRAY:
+  case BPF_MAP_TYPE_LRU_PERCPU_HASH:
+  case BPF_MAP_TYPE_PERCPU_CGROUP_STORAGE: {
+    num_cpus_ = libbpf_num_possible_cpus();
+    if (num_cpus_ <= 0)
+      throw BpfException("Failed to get number of possible CPUs: " +
+                         std::string(std::strerror(-num_cpus_)));
+    percpu_ = true;
+    value_stride_ = (value_size_ + 7) & ~7U;
+    value_buf_size_ = static_cast<size_t>(value_stride_) * num_cpus_;
+    break;
+  }
+  default:
+    break;
+  }
+
+  scratch_.resize(scratch_value_offset() + value_buf_size_);
+}
+
+BpfMap::ScratchLease::ScratchLease(const BpfMap &map) : owner_(nullptr) {
+  const size_t offset = map.scratch_value_offset();
+  uint8_t *base;
+  if (!map.scratch_leased_) {
+    map.scratch_leased_ = true;
+    owner_ = &map;
+    base = map.scratch_.data();
+  } else {
+    fallback_.resize(offset + map.value_buf_size_);
+    base = fallback_.data();
+  }
+  key = {base, map.key_size_};
+  value = {base + offset, map.value_buf_size_};
+}
+
+BpfMap::ScratchLease::~ScratchLease() {
+  if (owner_)
+    owner_->scratch_leased_ = false;
+}
+
+size_t BpfMap::scratch_value_offset() const {
+  return (static_cast<size_t>(key_size_) + 7) & ~size_t{7};
 }
 
 py::object BpfMap::lookup(const py::object &key) const {
   if (map_fd_ < 0)
     throw BpfException("Map '" + map_name_ + "' is not initialized properly");
 
-  BufferManager<> key_buf, value_buf;
-  auto key_span = key_buf.get_span(key_size_);
-  auto value_span = value_buf.get_span(value_size_);
+  ScratchLease scratch(*this);
+  auto key_span = scratch.key;
+  auto value_span = scratch.value;
 
   // Convert Python → bytes
-  python_to_bytes_inplace(key, key_span);
+  encode_key(key, key_span);
 
   // The flags field here matters only when spin locks are used.
   // Skipping it for now.
-  const int ret = bpf_map__lookup_elem(map_, key_span.data(), key_size_,
-                                       value_span.data(), value_size_, BPF_ANY);
+  const int ret =
+      bpf_map__lookup_elem(map_, key_span.data(), key_size_, value_span.data(),
+                           value_buf_size_, BPF_ANY);
   if (ret < 0) {
     if (ret == -ENOENT)
       throw py::key_error("Key not found in map '" + map_name_ + "'");
@@ -47,28 +124,79 @@ py::object BpfMap::lookup(const py::object &key) const {
                        "': " + std::strerror(-ret));
   }
 
-  return bytes_to_python(value_span);
+  return decode_value(value_span);
 }
 
 void BpfMap::update(const py::object &key, const py::object &value) const {
   if (map_fd_ < 0)
     throw BpfException("Map '" + map_name_ + "' is not initialized properly");
 
-  BufferManager<> key_buf, value_buf;
-  auto key_span = key_buf.get_span(key_size_);
-  auto value_span = value_buf.get_span(value_size_);
+  ScratchLease scratch(*this);
+  auto key_span = scratch.key;
+  auto value_span = scratch.value;
 
-  python_to_bytes_inplace(key, key_span);
-  python_to_bytes_inplace(value, value_span);
+  encode_key(key, key_span);
+  encode_value(value, value_span);
 
-  const int ret = bpf_map__update_elem(map_, key_span.data(), key_size_,
-                                       value_span.data(), value_size_, BPF_ANY);
+  const int ret =
+      bpf_map__update_elem(map_, key_span.data(), key_size_, value_span.data(),
+                           value_buf_size_, BPF_ANY);
   if (ret < 0) {
     throw BpfException("Failed to update key in map '" + map_name_ +
                        "': " + std::strerror(-ret));
   }
 }
 
+bool BpfMap::lookup_into(const py::object &key, const py::buffer &out) const {
+  if (map_fd_ < 0)
+    throw BpfException("Map '" + map_name_ + "' is not initialized properly");
+
+  const py::buffer_info info = out.request(true);
+  auto value_span = value_buffer(info);
+
+  ScratchLease scratch(*this);
+  encode_key(key, scratch.key);
+
+  const int ret =
+      bpf_map__lookup_elem(map_, scratch.key.data(), key_size_,
+                           value_span.data(), value_buf_size_, BPF_ANY);
+  if (ret == -ENOENT)
+    return false;
+  if (ret < 0)
+    throw BpfException("Failed to lookup key in map '" + map_name_ +
+                       "': " + std::strerror(-ret));
+  return true;
+}
+
+void BpfMap::update_from(const py::object &key, const py::buffer &value,
+                         __u64 flags) const {
+  if (map_fd_ < 0)
+    throw BpfException("Map '" + map_name_ + "' is not initialized properly");
+
+  const py::buffer_info info = value.request();
+  auto value_span = value_buffer(info);
+
+  ScratchLease scratch(*this);
+  encode_key(key, scratch.key);
+
+  const int ret = bpf_map__update_elem(map_, scratch.key.data(), key_size_,
+                                       value_span.data(), value_buf_size_,
+                                       flags);
+  if (ret < 0)
+    throw BpfException("Failed to update key in map '" + map_name_ +
+                       "': " + std::strerror(-ret));
+}
+
+std::span<uint8_t> BpfMap::value_buffer(const py::buffer_info &info) const {
+  auto bytes = contiguous_bytes(info, 1, "Value");
+  if (bytes.size() != value_buf_size_)
+    throw BpfException("Value buffer holds " + std::to_string(bytes.size()) +
+                       " bytes, map '" + map_name_ + "' needs " +
+                       std::to_string(value_buf_size_));
+  // Writability was checked by the buffer request where it matters
+  return {const_cast<uint8_t *>(bytes.data()), bytes.size()};
+}
+
 void BpfMap::delete_elem(const py::object &key) const {
   if (map_fd_ < 0)
     throw BpfException("Map '" + map_name_ + "' is not initialized properly");
@@ -77,7 +205,7 @@ void BpfMap::delete_elem(const py::object &key) const {
   auto key_span = key_buf.get_span(key_size_);
 
   // Convert Python → bytes
-  python_to_bytes_inplace(key, key_span);
+  encode_key(key, key_span);
 
   const int ret =
       bpf_map__delete_elem(map_, key_span.data(), key_size_, BPF_ANY);
@@ -100,7 +228,7 @@ py::object BpfMap::get_next_key(const py::object &key) const {
   } else {
     BufferManager<> key_buf;
     auto key_bytes = key_buf.get_span(key_size_);
-    python_to_bytes_inplace(key, key_bytes);
+    encode_key(key, key_bytes);
     ret = bpf_map__get_next_key(map_, key_bytes.data(), next_key.data(),
                                 key_size_);
   }
@@ -114,72 +242,823 @@ py::object BpfMap::get_next_key(const py::object &key) const {
                        "': " + std::strerror(-ret));
   }
 
-  return bytes_to_python(next_key);
+  return decode_key(next_key);
 }
 
-py::dict BpfMap::items() const {
+py::dict BpfMap::items(__u32 chunk_size) const {
+  if (chunk_size == 0)
+    throw BpfException("chunk_size must be positive");
+
   py::dict result;
+  DumpCursor cursor;
+  std::vector<uint8_t> keys(static_cast<size_t>(chunk_size) * key_size_);
+  std::vector<uint8_t> values(static_cast<size_t>(chunk_size) *
+                              value_buf_size_);
 
-  py::object current_key = get_next_key(py::none());
-  if (current_key.is_none()) {
-    return result;
+  while (!cursor.done) {
+    const size_t n = dump_chunk(cursor, keys, values, chunk_size);
+    for (size_t i = 0; i < n; ++i) {
+      auto key = std::span<const uint8_t>(keys).subspan(i * key_size_,
+                                                       key_size_);
+      auto value = std::span<const uint8_t>(values).subspan(i * value_buf_size_,
+                                                           value_buf_size_);
+      result[decode_key(key)] = decode_value(value);
+    }
   }
 
-  while (!current_key.is_none()) {
-    try {
-      py::object value = lookup(current_key);
-      result[current_key] = value;
-      current_key = get_next_key(current_key);
-    } catch (const py::key_error &) {
-      break;
+  return result;
+}
+
+py::list BpfMap::keys(__u32 chunk_size) const {
+  if (chunk_size == 0)
+    throw BpfException("chunk_size must be positive");
+
+  py::list result;
+  DumpCursor cursor;
+  std::vector<uint8_t> keys(static_cast<size_t>(chunk_size) * key_size_);
+  std::vector<uint8_t> values(static_cast<size_t>(chunk_size) *
+                              value_buf_size_);
+
+  while (!cursor.done) {
+    const size_t n = dump_chunk(cursor, keys, values, chunk_size);
+    for (size_t i = 0; i < n; ++i) {
+      result.append(decode_key(
+          std::span<const uint8_t>(keys).subspan(i * key_size_, key_size_)));
     }
   }
 
   return result;
 }
 
-py::list BpfMap::keys() const {
+py::list BpfMap::values(__u32 chunk_size) const {
+  if (chunk_size == 0)
+    throw BpfException("chunk_size must be positive");
+
   py::list result;
+  DumpCursor cursor;
+  std::vector<uint8_t> keys(static_cast<size_t>(chunk_size) * key_size_);
+  std::vector<uint8_t> values(static_cast<size_t>(chunk_size) *
+                              value_buf_size_);
+
+  while (!cursor.done) {
+    const size_t n = dump_chunk(cursor, keys, values, chunk_size);
+    for (size_t i = 0; i < n; ++i) {
+      result.append(decode_value(std::span<const uint8_t>(values).subspan(
+          i * value_buf_size_, value_buf_size_)));
+    }
+  }
+
+  return result;
+}
+
+std::shared_ptr<BpfMapIterator> BpfMap::iter_items(__u32 chunk_size) const {
+  return std::make_shared<BpfMapIterator>(
+      shared_from_this(), BpfMapIterator::Mode::Items, chunk_size);
+}
+
+std::shared_ptr<BpfMapIterator> BpfMap::iter_keys(__u32 chunk_size) const {
+  return std::make_shared<BpfMapIterator>(
+      shared_from_this(), BpfMapIterator::Mode::Keys, chunk_size);
+}
+
+std::shared_ptr<BpfMapIterator> BpfMap::iter_values(__u32 chunk_size) const {
+  return std::make_shared<BpfMapIterator>(
+      shared_from_this(), BpfMapIterator::Mode::Values, chunk_size);
+}
+
+// ==================== Batched Operations ====================
+
+size_t BpfMap::dump_chunk(DumpCursor &cursor, std::span<uint8_t> keys,
+                          std::span<uint8_t> values,
+                          size_t max_entries) const {
+  if (map_fd_ < 0)
+    throw BpfException("Map '" + map_name_ + "' is not initialized properly");
+  if (cursor.done || max_entries == 0)
+    return 0;
+  if (keys.size() < max_entries * key_size_ ||
+      values.size() < max_entries * value_buf_size_)
+    throw BpfException("Dump buffers too small for map '" + map_name_ + "'");
+
+  if (cursor.per_key)
+    return dump_chunk_per_key(cursor, keys, values, max_entries);
+
+  if (cursor.batch_in.empty()) {
+    cursor.batch_in.resize(batch_token_size());
+    cursor.batch_out.resize(batch_token_size());
+  }
+
+  struct bpf_map_batch_opts opts = {};
+  opts.sz = sizeof(opts);
+
+  auto count = static_cast<__u32>(max_entries);
+  int ret;
+  {
+    py::gil_scoped_release release;
+    void *in_batch = cursor.started ? cursor.batch_in.data() : nullptr;
+    if (cursor.drain)
+      ret = bpf_map_lookup_and_delete_batch(map_fd_, in_batch,
+                                            cursor.batch_out.data(),
+                                            keys.data(), values.data(), &count,
+                                            &opts);
+    else
+      ret = bpf_map_lookup_batch(map_fd_, in_batch, cursor.batch_out.data(),
+                                 keys.data(), values.data(), &count, &opts);
+  }
+
+  if (ret < 0 && ret != -ENOENT) {
+    if (!cursor.started && is_unsupported_op(ret)) {
+      cursor.per_key = true;
+      return dump_chunk_per_key(cursor, keys, values, max_entries);
+    }
+    if (ret == -ENOSPC)
+      throw BpfException("Batch size " + std::to_string(max_entries) +
+                         " is too small for a hash bucket in map '" +
+                         map_name_ + "'");
+    throw BpfException("Failed to batch " +
+                       std::string(cursor.drain ? "drain" : "lookup") +
+                       " map '" + map_name_ + "': " + std::strerror(-ret));
+  }
+
+  cursor.started = true;
+  cursor.batch_in.swap(cursor.batch_out);
+  if (ret == -ENOENT)
+    cursor.done = true;
+
+  return count;
+}
+
+size_t BpfMap::dump_chunk_per_key(DumpCursor &cursor, std::span<uint8_t> keys,
+                                  std::span<uint8_t> values,
+                                  size_t max_entries) const {
+  if (cursor.last_key.empty())
+    cursor.last_key.resize(key_size_);
+  // No walk can legitimately see more keys than the map holds
+  const size_t max_keys = bpf_map__max_entries(map_);
+
+  py::gil_scoped_release release;
+
+  size_t n = 0;
+  while (n < max_entries) {
+    uint8_t *key = keys.data() + n * key_size_;
+    uint8_t *value = values.data() + n * value_buf_size_;
+
+    if (cursor.keys_walked >= max_keys) {
+      cursor.done = true;
+      break;
+    }
+
+    // Drained keys are gone, so restart from the head every time
+    const bool resume = cursor.started && !cursor.drain;
+    int ret = bpf_map__get_next_key(
+        map_, resume ? cursor.last_key.data() : nullptr, key, key_size_);
+    if (ret == -ENOENT) {
+      cursor.done = true;
+      break;
+    }
+    if (ret < 0)
+      throw BpfException("Failed to get next key in map '" + map_name_ +
+                         "': " + std::strerror(-ret));
+
+    cursor.started = true;
+    ++cursor.keys_walked;
+    std::memcpy(cursor.last_key.data(), key, key_size_);
+
+    if (cursor.drain)
+      ret = lookup_and_delete_per_key(key, value);
+    else
+      ret = bpf_map__lookup_elem(map_, key, key_size_, value, value_buf_size_,
+                                 0);
+    if (ret == -ENOENT)
+      continue; // Deleted between get_next_key and lookup
+    if (ret < 0)
+      throw BpfException("Failed to lookup key in map '" + map_name_ +
+                         "': " + std::strerror(-ret));
+    ++n;
+  }
+
+  return n;
+}
+
+py::tuple BpfMap::lookup_batch(const py::object &in_batch, __u32 count) const {
+  if (count == 0)
+    throw BpfException("count must be positive");
+
+  DumpCursor cursor;
+  cursor.batch_in.resize(batch_token_size());
+  cursor.batch_out.resize(batch_token_size());
+  if (!in_batch.is_none()) {
+    std::string token = in_batch.cast<std::string>();
+    if (token.size() != cursor.batch_in.size())
+      throw BpfException("Invalid batch token for map '" + map_name_ + "'");
+    std::memcpy(cursor.batch_in.data(), token.data(), token.size());
+    cursor.started = true;
+  }
+
+  std::vector<uint8_t> keys(static_cast<size_t>(count) * key_size_);
+  std::vector<uint8_t> values(static_cast<size_t>(count) * value_buf_size_);
+
+  auto n = static_cast<__u32>(count);
+  struct bpf_map_batch_opts opts = {};
+  opts.sz = sizeof(opts);
+  int ret;
+  {
+    py::gil_scoped_release release;
+    ret = bpf_map_lookup_batch(
+        map_fd_, cursor.started ? cursor.batch_in.data() : nullptr,
+        cursor.batch_out.data(), keys.data(), values.data(), &n, &opts);
+  }
+  if (ret < 0 && ret != -ENOENT)
+    throw BpfException("Failed to batch lookup map '" + map_name_ +
+                       "': " + std::strerror(-ret));
+
+  py::list py_keys, py_values;
+  for (__u32 i = 0; i < n; ++i) {
+    py_keys.append(decode_key(
+        std::span<const uint8_t>(keys).subspan(i * key_size_, key_size_)));
+    py_values.append(decode_value(std::span<const uint8_t>(values).subspan(
+        i * value_buf_size_, value_buf_size_)));
+  }
+
+  py::object next_batch = py::none();
+  if (ret != -ENOENT)
+    next_batch =
+        py::bytes(reinterpret_cast<const char *>(cursor.batch_out.data()),
+                  cursor.batch_out.size());
+
+  return py::make_tuple(py_keys, py_values, next_batch);
+}
+
+void BpfMap::update_batch(const py::list &keys, const py::list &values,
+                          __u64 flags) const {
+  if (map_fd_ < 0)
+    throw BpfException("Map '" + map_name_ + "' is not initialized properly");
+
+  const size_t n = py::len(keys);
+  if (py::len(values) != n)
+    throw BpfException("keys and values must have the same length");
+  if (n == 0)
+    return;
+
+  std::vector<uint8_t> key_buf(n * key_size_);
+  std::vector<uint8_t> value_buf(n * value_buf_size_);
+  for (size_t i = 0; i < n; ++i) {
+    encode_key(
+        keys[i], std::span<uint8_t>(key_buf).subspan(i * key_size_, key_size_));
+    encode_value(values[i], std::span<uint8_t>(value_buf).subspan(
+                                i * value_buf_size_, value_buf_size_));
+  }
+
+  update_raw(key_buf.data(), value_buf.data(), n, flags);
+}
+
+void BpfMap::update_raw(const uint8_t *keys, const uint8_t *values, size_t n,
+                        __u64 flags) const {
+  struct bpf_map_batch_opts opts = {};
+  opts.sz = sizeof(opts);
+  opts.elem_flags = flags;
+
+  auto count = static_cast<__u32>(n);
+  int ret;
+  {
+    py::gil_scoped_release release;
+    ret = bpf_map_update_batch(map_fd_, keys, values, &count, &opts);
+
+    if (ret < 0 && count == 0 && is_unsupported_op(ret)) {
+      ret = 0;
+      while (count < n) {
+        ret = bpf_map__update_elem(map_, keys + count * key_size_, key_size_,
+                                   values + count * value_buf_size_,
+                                   value_buf_size_, flags);
+        if (ret < 0)
+          break;
+        ++count;
+      }
+    }
+  }
+
+  if (ret < 0) {
+    throw BpfException("Failed to batch update map '" + map_name_ +
+                       "' after " + std::to_string(count) +
+                       " entries: " + std::strerror(-ret));
+  }
+}
+
+void BpfMap::delete_batch(const py::list &keys) const {
+  if (map_fd_ < 0)
+    throw BpfException("Map '" + map_name_ + "' is not initialized properly");
+
+  const size_t n = py::len(keys);
+  if (n == 0)
+    return;
+
+  std::vector<uint8_t> key_buf(n * key_size_);
+  for (size_t i = 0; i < n; ++i) {
+    encode_key(
+        keys[i], std::span<uint8_t>(key_buf).subspan(i * key_size_, key_size_));
+  }
+
+  struct bpf_map_batch_opts opts = {};
+  opts.sz = sizeof(opts);
+
+  auto count = static_cast<__u32>(n);
+  int ret;
+  {
+    py::gil_scoped_release release;
+    ret = bpf_map_delete_batch(map_fd_, key_buf.data(), &count, &opts);
+
+    if (ret < 0 && count == 0 && is_unsupported_op(ret)) {
+      ret = 0;
+      while (count < n) {
+        ret = bpf_map__delete_elem(map_, key_buf.data() + count * key_size_,
+                                   key_size_, BPF_ANY);
+        if (ret < 0)
+          break;
+        ++count;
+      }
+    }
+  }
+
+  if (ret < 0) {
+    if (ret == -ENOENT)
+      throw py::key_error("Key not found in map '" + map_name_ + "' after " +
+                          std::to_string(count) + " deletions");
+    throw BpfException("Failed to batch delete from map '" + map_name_ +
+                       "': " + std::strerror(-ret));
+  }
+}
+
+int BpfMap::get_type() const { return bpf_map__type(map_); }
+
+int BpfMap::get_max_entries() const { return bpf_map__max_entries(map_); }
 
-  py::object current_key = get_next_key(py::none());
-  if (current_key.is_none()) {
-    return result;
+py::object BpfMap::drain(__u32 chunk_size) const {
+  if (chunk_size == 0)
+    throw BpfException("chunk_size must be positive");
+
+  switch (bpf_map__type(map_)) {
+  case BPF_MAP_TYPE_QUEUE:
+  case BPF_MAP_TYPE_STACK:
+    return drain_queue();
+  case BPF_MAP_TYPE_HASH:
+  case BPF_MAP_TYPE_PERCPU_HASH:
+  case BPF_MAP_TYPE_LRU_HASH:
+  case BPF_MAP_TYPE_LRU_PERCPU_HASH:
+    break;
+  default:
+    throw BpfException("Map '" + map_name_ + "' does not support draining");
   }
 
-  while (!current_key.is_none()) {
-    result.append(current_key);
-    current_key = get_next_key(current_key);
+  py::dict result;
+  DumpCursor cursor;
+  cursor.drain = true;
+  std::vector<uint8_t> keys(static_cast<size_t>(chunk_size) * key_size_);
+  std::vector<uint8_t> values(static_cast<size_t>(chunk_size) *
+                              value_buf_size_);
+
+  while (!cursor.done) {
+    const size_t n = dump_chunk(cursor, keys, values, chunk_size);
+    for (size_t i = 0; i < n; ++i) {
+      auto key = std::span<const uint8_t>(keys).subspan(i * key_size_,
+                                                       key_size_);
+      auto value = std::span<const uint8_t>(values).subspan(i * value_buf_size_,
+                                                           value_buf_size_);
+      result[decode_key(key)] = decode_value(value);
+    }
   }
 
   return result;
 }
 
-py::list BpfMap::values() const {
+py::list BpfMap::drain_queue() const {
   py::list result;
+  std::vector<uint8_t> value(value_buf_size_);
 
-  py::object current_key = get_next_key(py::none());
-  if (current_key.is_none()) {
-    return result;
+  while (true) {
+    int ret;
+    {
+      py::gil_scoped_release release;
+      ret = bpf_map__lookup_and_delete_elem(map_, nullptr, 0, value.data(),
+                                            value_buf_size_, 0);
+    }
+    if (ret == -ENOENT)
+      break;
+    if (ret < 0)
+      throw BpfException("Failed to pop from map '" + map_name_ +
+                         "': " + std::strerror(-ret));
+    result.append(decode_value(value));
   }
 
-  while (!current_key.is_none()) {
-    try {
-      py::object value = lookup(current_key);
-      result.append(value);
-      current_key = get_next_key(current_key);
-    } catch (const py::key_error &) {
-      break;
+  return result;
+}
+
+// ==================== Buffer Export ====================
+
+py::tuple BpfMap::export_buffers(__u32 chunk_size) const {
+  if (chunk_size == 0)
+    throw BpfException("chunk_size must be positive");
+
+  // Size for a full map up front so each chunk lands in its final place
+  size_t capacity = std::max<size_t>(get_max_entries(), chunk_size);
+  std::vector<uint8_t> keys(capacity * key_size_);
+  std::vector<uint8_t> values(capacity * value_buf_size_);
+
+  DumpCursor cursor;
+  size_t n = 0;
+  while (!cursor.done) {
+    if (capacity - n < chunk_size) {
+      // Entries churned while we walked the map; make room for another chunk
+      capacity = n + chunk_size;
+      keys.resize(capacity * key_size_);
+      values.resize(capacity * value_buf_size_);
+    }
+    n += dump_chunk(cursor, std::span<uint8_t>(keys).subspan(n * key_size_),
+                    std::span<uint8_t>(values).subspan(n * value_buf_size_),
+                    chunk_size);
+  }
+
+  // The exported views own these vectors, so don't let a sparse map pin
+  // max_entries worth of memory
+  keys.resize(n * key_size_);
+  keys.shrink_to_fit();
+  values.resize(n * value_buf_size_);
+  values.shrink_to_fit();
+
+  return py::make_tuple(MapBuffer::records(std::move(keys), n, key_size_),
+                        make_value_buffer(std::move(values), n));
+}
+
+py::tuple BpfMap::lookup_many(const py::buffer &keys) const {
+  if (map_fd_ < 0)
+    throw BpfException("Map '" + map_name_ + "' is not initialized properly");
+
+  const py::buffer_info key_info = keys.request();
+  auto key_bytes = contiguous_bytes(key_info, key_size_, "keys");
+  const size_t n = key_bytes.size() / key_size_;
+
+  std::vector<uint8_t> values(n * value_buf_size_);
+  std::vector<uint8_t> found(n);
+  {
+    py::gil_scoped_release release;
+    for (size_t i = 0; i < n; ++i) {
+      const int ret = bpf_map__lookup_elem(
+          map_, key_bytes.data() + i * key_size_, key_size_,
+          values.data() + i * value_buf_size_, value_buf_size_, 0);
+      if (ret < 0 && ret != -ENOENT)
+        throw BpfException("Failed to lookup key in map '" + map_name_ +
+                           "': " + std::strerror(-ret));
+      found[i] = ret == 0;
+    }
+  }
+
+  return py::make_tuple(make_value_buffer(std::move(values), n),
+                        MapBuffer(std::move(found), "?", 1,
+                                  {static_cast<py::ssize_t>(n)}, {1}));
+}
+
+void BpfMap::update_many(const py::buffer &keys, const py::buffer &values,
+                         __u64 flags) const {
+  if (map_fd_ < 0)
+    throw BpfException("Map '" + map_name_ + "' is not initialized properly");
+
+  const py::buffer_info key_info = keys.request();
+  const py::buffer_info value_info = values.request();
+  auto key_bytes = contiguous_bytes(key_info, key_size_, "keys");
+  auto value_bytes = contiguous_bytes(value_info, value_buf_size_, "values");
+  const size_t n = key_bytes.size() / key_size_;
+  if (value_bytes.size() / value_buf_size_ != n)
+    throw BpfException("keys and values must have the same length");
+  if (n == 0)
+    return;
+
+  update_raw(key_bytes.data(), value_bytes.data(), n, flags);
+}
+
+MapBuffer BpfMap::make_value_buffer(std::vector<uint8_t> data,
+                                    size_t count) const {
+  if (!percpu_)
+    return MapBuffer::records(std::move(data), count, value_buf_size_);
+
+  // (entries, cpus) for integer values, (entries, cpus, bytes) otherwise
+  data.resize(count * value_buf_size_);
+  const auto rows = static_cast<py::ssize_t>(count);
+  const auto cpus = static_cast<py::ssize_t>(num_cpus_);
+  const auto row_stride = static_cast<py::ssize_t>(value_buf_size_);
+  const auto cpu_stride = static_cast<py::ssize_t>(value_stride_);
+
+  std::string format = MapBuffer::uint_format(value_size_);
+  if (!format.empty())
+    return MapBuffer(std::move(data), format, value_size_, {rows, cpus},
+                     {row_stride, cpu_stride});
+
+  return MapBuffer(std::move(data), py::format_descriptor<uint8_t>::format(),
+                   1, {rows, cpus, static_cast<py::ssize_t>(value_size_)},
+                   {row_stride, cpu_stride, 1});
+}
+
+std::span<const uint8_t> BpfMap::contiguous_bytes(const py::buffer_info &info,
+                                                  size_t record_size,
+                                                  const char *what) {
+  // Only C-contiguous buffers can be handed to the kernel as-is
+  py::ssize_t expected = info.itemsize;
+  for (py::ssize_t dim = info.ndim - 1; dim >= 0; --dim) {
+    if (info.shape[dim] > 1 && info.strides[dim] != expected)
+      throw BpfException(std::string(what) + " buffer must be C-contiguous");
+    expected *= info.shape[dim];
+  }
+
+  const size_t nbytes = static_cast<size_t>(info.size * info.itemsize);
+  if (nbytes % record_size != 0)
+    throw BpfException(std::string(what) + " buffer size " +
+                       std::to_string(nbytes) + " is not a multiple of " +
+                       std::to_string(record_size) + " bytes");
+
+  return {static_cast<const uint8_t *>(info.ptr), nbytes};
+}
+
+// ==================== Pinning ====================
+
+void BpfMap::pin(const std::string &path) const {
+  const int ret = bpf_map__pin(map_, path.c_str());
+  if (ret) {
+    throw BpfException("Failed to pin map '" + map_name_ + "' at '" + path +
+                       "': " + std::strerror(-ret));
+  }
+}
+
+void BpfMap::unpin(const std::string &path) const {
+  const int ret = bpf_map__unpin(map_, path.empty() ? nullptr : path.c_str());
+  if (ret) {
+    throw BpfException("Failed to unpin map '" + map_name_ +
+                       "': " + std::strerror(-ret));
+  }
+}
+
+bool BpfMap::is_pinned() const { return bpf_map__is_pinned(map_); }
+
+std::string BpfMap::get_pin_path() const {
+  const char *path = bpf_map__pin_path(map_);
+  return path ? path : "";
+}
+
+// ==================== Memory Mapping ====================
+
+bool BpfMap::is_mmapable() const {
+  return bpf_map__type(map_) == BPF_MAP_TYPE_ARRAY &&
+         (bpf_map__map_flags(map_) & BPF_F_MMAPABLE);
+}
+
+py::memoryview BpfMap::mmap() const {
+  if (!is_mmapable())
+    throw BpfException("Map '" + map_name_ + "' is not a mmapable array");
+
+  // Global data maps are already mapped by libbpf, borrow that mapping
+  if (bpf_map__is_internal(map_)) {
+    auto parent = parent_obj_.lock();
+    if (!parent)
+      throw BpfException("Parent BpfObject has been destroyed");
+
+    size_t size = 0;
+    void *addr = bpf_map__initial_value(map_, &size);
+    if (!addr)
+      throw BpfException("Map '" + map_name_ + "' has no memory mapping");
+
+    const bool readonly = bpf_map__map_flags(map_) & BPF_F_RDONLY_PROG;
+    auto region = std::make_shared<MmapRegion>(
+        addr, size, false, readonly, parent,
+        py::format_descriptor<uint8_t>::format(), 1,
+        std::vector<py::ssize_t>{static_cast<py::ssize_t>(size)},
+        std::vector<py::ssize_t>{1});
+    return py::memoryview(py::cast(region));
+  }
+
+  // Array elements are laid out on an 8-byte stride
+  const size_t elem_size = (value_size_ + 7) & ~7UL;
+  const size_t page_size = sysconf(_SC_PAGESIZE);
+  const size_t data_size = elem_size * get_max_entries();
+  const size_t length = (data_size + page_size - 1) & ~(page_size - 1);
+
+  bool readonly = false;
+  void *addr =
+      ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, map_fd_, 0);
+  if (addr == MAP_FAILED && (errno == EPERM || errno == EACCES)) {
+    // Frozen or BPF_F_RDONLY maps can only be mapped read-only
+    readonly = true;
+    addr = ::mmap(nullptr, length, PROT_READ, MAP_SHARED, map_fd_, 0);
+  }
+  if (addr == MAP_FAILED)
+    throw BpfException("Failed to mmap map '" + map_name_ +
+                       "': " + std::strerror(errno));
+
+  const auto entries = static_cast<py::ssize_t>(get_max_entries());
+  std::string format = MapBuffer::uint_format(value_size_);
+  std::shared_ptr<MmapRegion> region;
+  if (!format.empty()) {
+    region = std::make_shared<MmapRegion>(
+        addr, length, true, readonly, nullptr, format, value_size_,
+        std::vector<py::ssize_t>{entries},
+        std::vector<py::ssize_t>{static_cast<py::ssize_t>(elem_size)});
+  } else {
+    region = std::make_shared<MmapRegion>(
+        addr, length, true, readonly, nullptr,
+        py::format_descriptor<uint8_t>::format(), 1,
+        std::vector<py::ssize_t>{entries,
+                                 static_cast<py::ssize_t>(value_size_)},
+        std::vector<py::ssize_t>{static_cast<py::ssize_t>(elem_size), 1});
+  }
+
+  return py::memoryview(py::cast(region));
+}
+
+// ==================== Per-CPU Operations ====================
+
+py::object BpfMap::lookup_reduce(const py::object &key, PercpuReduce op) const {
+  if (!percpu_)
+    throw BpfException("Map '" + map_name_ + "' is not a per-CPU map");
+
+  ScratchLease scratch(*this);
+  auto key_span = scratch.key;
+  auto value_span = scratch.value;
+
+  encode_key(key, key_span);
+
+  const int ret = bpf_map__lookup_elem(map_, key_span.data(), key_size_,
+                                       value_span.data(), value_buf_size_, 0);
+  if (ret < 0) {
+    if (ret == -ENOENT)
+      throw py::key_error("Key not found in map '" + map_name_ + "'");
+    throw BpfException("Failed to lookup key in map '" + map_name_ +
+                       "': " + std::strerror(-ret));
+  }
+
+  return reduce_value(value_span, op);
+}
+
+py::dict BpfMap::items_reduce(PercpuReduce op, __u32 chunk_size) const {
+  if (!percpu_)
+    throw BpfException("Map '" + map_name_ + "' is not a per-CPU map");
+  if (chunk_size == 0)
+    throw BpfException("chunk_size must be positive");
+
+  py::dict result;
+  DumpCursor cursor;
+  std::vector<uint8_t> keys(static_cast<size_t>(chunk_size) * key_size_);
+  std::vector<uint8_t> values(static_cast<size_t>(chunk_size) *
+                              value_buf_size_);
+
+  while (!cursor.done) {
+    const size_t n = dump_chunk(cursor, keys, values, chunk_size);
+    for (size_t i = 0; i < n; ++i) {
+      auto key = std::span<const uint8_t>(keys).subspan(i * key_size_,
+                                                       key_size_);
+      auto value = std::span<const uint8_t>(values).subspan(
+          i * value_buf_size_, value_buf_size_);
+      result[decode_key(key)] = reduce_value(value, op);
     }
   }
 
   return result;
 }
 
-int BpfMap::get_type() const { return bpf_map__type(map_); }
+py::object BpfMap::reduce_value(std::span<const uint8_t> data,
+                                PercpuReduce op) const {
+  if (value_size_ % sizeof(uint64_t) != 0)
+    throw BpfException("Map '" + map_name_ +
+                       "' value size is not a multiple of 8 bytes");
 
-int BpfMap::get_max_entries() const { return bpf_map__max_entries(map_); }
+  const size_t slots = value_size_ / sizeof(uint64_t);
+  std::vector<uint64_t> acc(slots);
+
+  for (int cpu = 0; cpu < num_cpus_; ++cpu) {
+    const uint8_t *base =
+        data.data() + static_cast<size_t>(cpu) * value_stride_;
+    for (size_t i = 0; i < slots; ++i) {
+      uint64_t v;
+      std::memcpy(&v, base + i * sizeof(uint64_t), sizeof(v));
+      if (cpu == 0) {
+        acc[i] = v;
+        continue;
+      }
+      switch (op) {
+      case PercpuReduce::Sum:
+        acc[i] += v;
+        break;
+      case PercpuReduce::Min:
+        acc[i] = std::min(acc[i], v);
+        break;
+      case PercpuReduce::Max:
+        acc[i] = std::max(acc[i], v);
+        break;
+      }
+    }
+  }
+
+  if (slots == 1)
+    return py::int_(acc[0]);
+
+  py::list result;
+  for (uint64_t v : acc)
+    result.append(v);
+  return result;
+}
 
 // Helper functions
+void BpfMap::encode_value(const py::object &obj,
+                          std::span<uint8_t> buffer) const {
+  if (!percpu_) {
+    encode_slot(obj, buffer);
+    return;
+  }
+
+  std::fill(buffer.begin(), buffer.end(), 0);
+
+  // A sequence supplies one value per CPU, anything else is replicated
+  if (py::isinstance<py::list>(obj) || py::isinstance<py::tuple>(obj)) {
+    auto seq = py::reinterpret_borrow<py::sequence>(obj);
+    if (seq.size() != static_cast<size_t>(num_cpus_))
+      throw BpfException("Expected " + std::to_string(num_cpus_) +
+                         " per-CPU values for map '" + map_name_ + "', got " +
+                         std::to_string(seq.size()));
+    for (int cpu = 0; cpu < num_cpus_; ++cpu)
+      encode_slot(
+          seq[cpu], buffer.subspan(static_cast<size_t>(cpu) * value_stride_,
+                                   value_size_));
+    return;
+  }
+
+  encode_slot(obj, buffer.first(value_size_));
+  for (int cpu = 1; cpu < num_cpus_; ++cpu)
+    std::memcpy(buffer.data() + static_cast<size_t>(cpu) * value_stride_,
+                buffer.data(), value_size_);
+}
+
+py::object BpfMap::decode_value(std::span<const uint8_t> data) const {
+  if (!percpu_)
+    return decode_slot(data);
+
+  py::list result;
+  for (int cpu = 0; cpu < num_cpus_; ++cpu)
+    result.append(decode_slot(data.subspan(
+        static_cast<size_t>(cpu) * value_stride_, value_size_)));
+  return result;
+}
+
+void BpfMap::encode_key(const py::object &obj,
+                        std::span<uint8_t> buffer) const {
+  if (key_codec_)
+    key_codec_->encode(obj, buffer.data(), buffer.size());
+  else
+    python_to_bytes_inplace(obj, buffer);
+}
+
+py::object BpfMap::decode_key(std::span<const uint8_t> data) const {
+  if (!key_codec_)
+    return bytes_to_python(data);
+  // Keys index dicts, so never hand them out as (unhashable) dicts
+  const StructFormat format = struct_format_ == StructFormat::Dict
+                                  ? StructFormat::NamedTuple
+                                  : struct_format_;
+  return key_codec_->decode(data.data(), data.size(), format, true);
+}
+
+void BpfMap::encode_slot(const py::object &obj,
+                         std::span<uint8_t> buffer) const {
+  if (value_codec_)
+    value_codec_->encode(obj, buffer.data(), buffer.size());
+  else
+    python_to_bytes_inplace(obj, buffer);
+}
+
+py::object BpfMap::decode_slot(std::span<const uint8_t> data) const {
+  if (!value_codec_)
+    return bytes_to_python(data);
+  return value_codec_->decode(data.data(), data.size(), struct_format_, true);
+}
+
+int BpfMap::lookup_and_delete_per_key(void *key, void *value) const {
+  int ret = bpf_map__lookup_and_delete_elem(map_, key, key_size_, value,
+                                            value_buf_size_, 0);
+  if (!is_unsupported_op(ret))
+    return ret;
+
+  // Hash maps only support lookup-and-delete since 5.14. This fallback is
+  // not atomic: an update between the lookup and the delete is lost.
+  ret = bpf_map__lookup_elem(map_, key, key_size_, value, value_buf_size_, 0);
+  if (ret < 0)
+    return ret;
+  return bpf_map__delete_elem(map_, key, key_size_, BPF_ANY);
+}
+
+size_t BpfMap::batch_token_size() const {
+  // Hash maps use a u32 bucket index as the token, arrays use the key itself.
+  return std::max<size_t>(key_size_, sizeof(__u64));
+}
+
+bool BpfMap::is_unsupported_op(int err) {
+  // Older kernels reject the command with EINVAL; map types without batch
+  // support report ENOTSUPP (524), which leaks out of the kernel as-is.
+  return err == -EINVAL || err == -EOPNOTSUPP || err == -524;
+}
+
 void BpfMap::python_to_bytes_inplace(const py::object &obj,
                                      std::span<uint8_t> buffer) {
   std::fill(buffer.begin(), buffer.end(), 0);
@@ -1,14 +1,19 @@
 #ifndef PYLIBBPF_BPF_MAP_H
 #define PYLIBBPF_BPF_MAP_H
 
+#include "utils/btf_codec.h"
 #include <array>
+#include <bpf.h>
 #include <libbpf.h>
+#include <memory>
 #include <pybind11/pybind11.h>
 #include <span>
 #include <string>
 #include <vector>
 
+class BpfMapIterator;
 class BpfObject;
+class MapBuffer;
 
 namespace py = pybind11;
 
@@ -19,6 +24,33 @@ private:
   int map_fd_;
   std::string map_name_;
   __u32 key_size_, value_size_;
+  // Per-CPU maps hold one 8-byte aligned slot per possible CPU
+  bool percpu_;
+  int num_cpus_;
+  __u32 value_stride_;
+  size_t value_buf_size_;
+  // Typed codecs built from the map's BTF; null falls back to heuristics
+  std::shared_ptr<const BtfCodec> key_codec_, value_codec_;
+  StructFormat struct_format_;
+  // Key + value storage reused by lookup()/update() so steady-state access
+  // never touches the heap. The GIL guards it; a re-entrant call made while
+  // encoding runs Python code finds it leased and uses its own buffer.
+  mutable std::vector<uint8_t> scratch_;
+  mutable bool scratch_leased_;
+
+  class ScratchLease {
+  public:
+    explicit ScratchLease(const BpfMap &map);
+    ~ScratchLease();
+    ScratchLease(const ScratchLease &) = delete;
+    ScratchLease &operator=(const ScratchLease &) = delete;
+
+    std::span<uint8_t> key, value;
+
+  private:
+    const BpfMap *owner_;
+    std::vector<uint8_t> fallback_;
+  };
 
   template <size_t StackSize = 64> struct BufferManager {
     std::array<uint8_t, StackSize> stack_buf;
@@ -35,6 +67,28 @@ private:
   };
 
 public:
+  // Cross-CPU reductions for per-CPU maps, applied to each u64 slot.
+  enum class PercpuReduce { Sum, Min, Max };
+
+  // Number of entries requested per batched syscall when dumping the map.
+  static constexpr __u32 kDefaultBatchSize = 256;
+
+  // Position within a chunked dump of the map. Starts at the first entry and
+  // switches to a get_next_key walk if the kernel lacks batch operations.
+  // With `drain` set, every entry returned is also deleted from the map.
+  // The get_next_key walk stops after max_entries keys, so it ends even
+  // while the program keeps inserting (a drain restarts from the head).
+  struct DumpCursor {
+    std::vector<uint8_t> batch_in;
+    std::vector<uint8_t> batch_out;
+    std::vector<uint8_t> last_key;
+    size_t keys_walked = 0;
+    bool started = false;
+    bool done = false;
+    bool per_key = false;
+    bool drain = false;
+  };
+
   BpfMap(std::shared_ptr<BpfObject> parent, struct bpf_map *raw_map,
          const std::string &map_name);
 
@@ -49,9 +103,85 @@ public:
   void update(const py::object &key, const py::object &value) const;
   void delete_elem(const py::object &key) const;
   py::object get_next_key(const py::object &key = py::none()) const;
-  py::dict items() const;
-  py::list keys() const;
-  py::list values() const;
+  py::dict items(__u32 chunk_size = kDefaultBatchSize) const;
+  py::list keys(__u32 chunk_size = kDefaultBatchSize) const;
+  py::list values(__u32 chunk_size = kDefaultBatchSize) const;
+  // Streaming counterparts that fetch one chunk at a time
+  std::shared_ptr<BpfMapIterator>
+  iter_items(__u32 chunk_size = kDefaultBatchSize) const;
+  std::shared_ptr<BpfMapIterator>
+  iter_keys(__u32 chunk_size = kDefaultBatchSize) const;
+  std::shared_ptr<BpfMapIterator>
+  iter_values(__u32 chunk_size = kDefaultBatchSize) const;
+
+  // Batched operations. lookup_batch returns (keys, values, next_batch) and
+  // maps directly onto BPF_MAP_LOOKUP_BATCH; next_batch is None at the end.
+  py::tuple lookup_batch(const py::object &in_batch = py::none(),
+                         __u32 count = kDefaultBatchSize) const;
+  void update_batch(const py::list &keys, const py::list &values,
+                    __u64 flags = BPF_ANY) const;
+  void delete_batch(const py::list &keys) const;
+
+  /**
+   * Read and remove every entry, each one atomically. Hash maps return a
+   * dict, queue/stack maps return a list of values in pop order. Entries
+   * added while draining may be left for the next call. Before Linux 5.14
+   * hash maps fall back to a lookup followed by a delete, which is not
+   * atomic: an update landing in between is lost.
+   */
+  py::object drain(__u32 chunk_size = kDefaultBatchSize) const;
+
+  /**
+   * Fill `keys` and `values` with up to `max_entries` entries following
+   * `cursor`. The GIL is released while talking to the kernel.
+   * Returns the number of entries written; cursor.done is set once the
+   * whole map has been walked.
+   */
+  size_t dump_chunk(DumpCursor &cursor, std::span<uint8_t> keys,
+                    std::span<uint8_t> values, size_t max_entries) const;
+
+  /**
+   * Zero-copy export for NumPy and friends. Returns (keys, values) as
+   * MapBuffer objects filled straight from the batched dump.
+   */
+  py::tuple export_buffers(__u32 chunk_size = kDefaultBatchSize) const;
+  /**
+   * Copy-free single-element access. lookup_into() fills a writable buffer
+   * of exactly value_size bytes (all CPU slots for per-CPU maps) and
+   * returns False if the key is absent; update_from() writes such a buffer.
+   */
+  bool lookup_into(const py::object &key, const py::buffer &out) const;
+  void update_from(const py::object &key, const py::buffer &value,
+                   __u64 flags = BPF_ANY) const;
+  // Vectorized lookup of a contiguous key array; returns (values, found)
+  py::tuple lookup_many(const py::buffer &keys) const;
+  void update_many(const py::buffer &keys, const py::buffer &values,
+                   __u64 flags = BPF_ANY) const;
+
+  /**
+   * Map the values of a BPF_F_MMAPABLE array (including .bss/.data/.rodata)
+   * into this process. Reads and writes go straight to kernel memory with
+   * no syscalls; .rodata and frozen maps are exposed read-only.
+   */
+  [[nodiscard]] py::memoryview mmap() const;
+  [[nodiscard]] bool is_mmapable() const;
+
+  /**
+   * Pin the map to bpffs so it outlives this process; a later object that
+   * sets the same pin path before load reuses it, contents included.
+   * unpin() with no path removes the current pin.
+   */
+  void pin(const std::string &path) const;
+  void unpin(const std::string &path = "") const;
+  [[nodiscard]] bool is_pinned() const;
+  [[nodiscard]] std::string get_pin_path() const;
+
+  // Per-CPU access. lookup()/items() already return one value per CPU for
+  // per-CPU maps; these variants fold all CPUs into one value natively.
+  [[nodiscard]] py::object lookup_reduce(const py::object &key,
+                                         PercpuReduce op) const;
+  py::dict items_reduce(PercpuReduce op,
+                        __u32 chunk_size = kDefaultBatchSize) const;
 
   [[nodiscard]] std::string get_name() const { return map_name_; }
   [[nodiscard]] int get_fd() const { return map_fd_; }
@@ -59,11 +189,51 @@ public:
   [[nodiscard]] int get_key_size() const { return key_size_; };
   [[nodiscard]] int get_value_size() const { return value_size_; };
   [[nodiscard]] int get_max_entries() const;
+  [[nodiscard]] bool is_percpu() const { return percpu_; }
+  [[nodiscard]] int get_num_cpus() const { return num_cpus_; }
+  // True when keys/values are encoded from BTF rather than by size
+  [[nodiscard]] bool has_btf_key() const { return key_codec_ != nullptr; }
+  [[nodiscard]] bool has_btf_value() const { return value_codec_ != nullptr; }
+  // Struct values decode to namedtuples by default; keys stay hashable
+  void set_struct_format(StructFormat format) { struct_format_ = format; }
+  [[nodiscard]] StructFormat get_struct_format() const {
+    return struct_format_;
+  }
   [[nodiscard]] std::shared_ptr<BpfObject> get_parent() const {
     return parent_obj_.lock();
   }
 
 private:
+  friend class BpfMapIterator;
+
+  [[nodiscard]] size_t batch_token_size() const;
+  [[nodiscard]] size_t scratch_value_offset() const;
+  [[nodiscard]] std::span<uint8_t>
+  value_buffer(const py::buffer_info &info) const;
+  size_t dump_chunk_per_key(DumpCursor &cursor, std::span<uint8_t> keys,
+                            std::span<uint8_t> values,
+                            size_t max_entries) const;
+  // Not atomic on kernels without per-key lookup-and-delete (see drain())
+  int lookup_and_delete_per_key(void *key, void *value) const;
+  void update_raw(const uint8_t *keys, const uint8_t *values, size_t n,
+                  __u64 flags) const;
+  [[nodiscard]] MapBuffer make_value_buffer(std::vector<uint8_t> data,
+                                            size_t count) const;
+  static std::span<const uint8_t> contiguous_bytes(const py::buffer_info &info,
+                                                   size_t record_size,
+                                                   const char *what);
+  py::list drain_queue() const;
+
+  void encode_key(const py::object &obj, std::span<uint8_t> buffer) const;
+  [[nodiscard]] py::object decode_key(std::span<const uint8_t> data) const;
+  void encode_slot(const py::object &obj, std::span<uint8_t> buffer) const;
+  [[nodiscard]] py::object decode_slot(std::span<const uint8_t> data) const;
+  void encode_value(const py::object &obj, std::span<uint8_t> buffer) const;
+  [[nodiscard]] py::object decode_value(std::span<const uint8_t> data) const;
+  [[nodiscard]] py::object reduce_value(std::span<const uint8_t> data,
+                                        PercpuReduce op) const;
+
+  static bool is_unsupported_op(int err);
   static void python_to_bytes_inplace(const py::object &obj,
                                       std::span<uint8_t> buffer);
   static py::object bytes_to_python(std::span<const uint8_t> data);
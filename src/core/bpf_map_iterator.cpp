@@ -0,0 +1,54 @@
+#include "core/bpf_map_iterator.h"
+#include "core/bpf_exception.h"
+#include <utility>
+
+BpfMapIterator::BpfMapIterator(std::shared_ptr<const BpfMap> map, Mode mode,
+                               __u32 chunk_size)
+    : map_(std::move(map)), mode_(mode), chunk_size_(chunk_size), count_(0),
+      pos_(0) {
+  if (!map_)
+    throw BpfException("BpfMap is null");
+  if (chunk_size_ == 0)
+    throw BpfException("chunk_size must be positive");
+
+  keys_.resize(static_cast<size_t>(chunk_size_) * map_->key_size_);
+  values_.resize(static_cast<size_t>(chunk_size_) * map_->value_buf_size_);
+}
+
+bool BpfMapIterator::fill() {
+  // A chunk can come back empty mid-walk (per-key fallback racing with
+  // deletes), so keep reading until entries arrive or the walk ends
+  while (pos_ == count_) {
+    if (cursor_.done)
+      return false;
+    count_ = map_->dump_chunk(cursor_, keys_, values_, chunk_size_);
+    pos_ = 0;
+  }
+  return true;
+}
+
+py::object BpfMapIterator::next() {
+  if (!fill()) {
+    // Drop the buffers as soon as the walk is over
+    keys_ = {};
+    values_ = {};
+    throw py::stop_iteration();
+  }
+
+  const size_t i = pos_++;
+  const size_t key_size = map_->key_size_;
+  const size_t value_size = map_->value_buf_size_;
+  auto key = std::span<const uint8_t>(keys_).subspan(i * key_size, key_size);
+  auto value =
+      std::span<const uint8_t>(values_).subspan(i * value_size, value_size);
+
+  switch (mode_) {
+  case Mode::Keys:
+    return map_->decode_key(key);
+  case Mode::Values:
+    return map_->decode_value(value);
+  case Mode::Items:
+    break;
+  }
+  return py::make_tuple(map_->decode_key(key), map_->decode_value(value));
+}
@@ -0,0 +1,43 @@
+#ifndef PYLIBBPF_BPF_MAP_ITERATOR_H
+#define PYLIBBPF_BPF_MAP_ITERATOR_H
+
+#include "core/bpf_map.h"
+#include <memory>
+#include <pybind11/pybind11.h>
+#include <vector>
+
+namespace py = pybind11;
+
+/**
+ * BpfMapIterator - Lazy walk over a map's entries.
+ *
+ * Entries are fetched `chunk_size` at a time through the batched dump (the
+ * GIL is released for each kernel read) and decoded one by one as Python
+ * asks for them, so memory stays bounded by a single chunk.
+ */
+class BpfMapIterator {
+public:
+  enum class Mode { Keys, Values, Items };
+
+  BpfMapIterator(std::shared_ptr<const BpfMap> map, Mode mode,
+                 __u32 chunk_size);
+
+  BpfMapIterator(const BpfMapIterator &) = delete;
+  BpfMapIterator &operator=(const BpfMapIterator &) = delete;
+
+  BpfMapIterator &iter() { return *this; }
+  // Raises StopIteration once the map has been walked
+  py::object next();
+
+private:
+  std::shared_ptr<const BpfMap> map_;
+  Mode mode_;
+  __u32 chunk_size_;
+  BpfMap::DumpCursor cursor_;
+  std::vector<uint8_t> keys_, values_;
+  size_t count_, pos_;
+
+  bool fill();
+};
+
+#endif // PYLIBBPF_BPF_MAP_ITERATOR_H
@@ -2,16 +2,117 @@
 #include "core/bpf_exception.h"
 #include "core/bpf_map.h"
 #include "core/bpf_program.h"
+#include "utils/btf_codec.h"
+#include "utils/object_cache.h"
 #include "utils/struct_parser.h"
+#include <algorithm>
+#include <atomic>
+#include <btf.h>
 #include <cerrno>
 #include <cstring>
+#include <thread>
+#include <unordered_set>
 #include <utility>
+#include <vector>
+
+namespace {
+
+struct GlobalVar {
+  struct bpf_map *map;
+  __u32 offset, size, type_id;
+};
+
+bool ends_with(const std::string &str, const std::string &suffix) {
+  return str.size() >= suffix.size() &&
+         str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// Find a global through the DATASEC describing the internal map it lives in
+GlobalVar find_global(struct bpf_object *obj, const std::string &name) {
+  const struct btf *btf = bpf_object__btf(obj);
+  if (!btf)
+    throw BpfException("BPF object has no BTF to resolve global '" + name +
+                       "'");
+
+  const __u32 type_cnt = btf__type_cnt(btf);
+  for (__u32 id = 1; id < type_cnt; ++id) {
+    const struct btf_type *sec = btf__type_by_id(btf, id);
+    if (!btf_is_datasec(sec))
+      continue;
+
+    const struct btf_var_secinfo *vi = btf_var_secinfos(sec);
+    for (__u16 i = 0; i < btf_vlen(sec); ++i, ++vi) {
+      const struct btf_type *var = btf__type_by_id(btf, vi->type);
+      if (!btf_is_var(var) || name != btf__name_by_offset(btf, var->name_off))
+        continue;
+
+      // Internal maps are named "<obj>.<section>", possibly truncated, so
+      // prefer the BTF link and fall back to the name
+      const std::string sec_name = btf__name_by_offset(btf, sec->name_off);
+      struct bpf_map *map = nullptr;
+      bpf_object__for_each_map(map, obj) {
+        if (bpf_map__is_internal(map) &&
+            (bpf_map__btf_value_type_id(map) == id ||
+             ends_with(bpf_map__name(map), sec_name)))
+          return {map, vi->offset, vi->size, var->type};
+      }
+      throw BpfException("No map backs section '" + sec_name +
+                         "' holding global '" + name + "'");
+    }
+  }
+
+  throw BpfException("Global variable '" + name + "' not found");
+}
+
+} // namespace
 
 BpfObject::BpfObject(std::string object_path, py::dict structs)
     : obj_(nullptr), object_path_(std::move(object_path)), loaded_(false),
-      struct_defs_(structs), struct_parser_(nullptr) {}
+      use_cache_(false), multi_attach_(false), struct_defs_(structs),
+      struct_parser_(nullptr) {}
+
+BpfObject::BpfObject(std::shared_ptr<const ObjectBlob> blob, bool use_cache,
+                     py::dict structs)
+    : obj_(nullptr), loaded_(false), blob_(std::move(blob)),
+      use_cache_(use_cache), multi_attach_(false), struct_defs_(structs),
+      struct_parser_(nullptr) {
+  if (!blob_)
+    throw BpfException("Object blob is null");
+  object_path_ = blob_->name.empty() ? "<memory>" : blob_->name;
+}
+
+std::shared_ptr<BpfObject> BpfObject::from_bytes(const py::buffer &data,
+                                                 const std::string &name,
+                                                 py::dict structs, bool cache) {
+  const py::buffer_info info = data.request();
+  if (info.ndim != 1 || info.strides[0] != info.itemsize)
+    throw BpfException("Object data must be a contiguous buffer");
+  std::span<const uint8_t> bytes(static_cast<const uint8_t *>(info.ptr),
+                                 static_cast<size_t>(info.size) *
+                                     static_cast<size_t>(info.itemsize));
+
+  std::shared_ptr<const ObjectBlob> blob;
+  if (cache) {
+    blob = ObjectCache::instance().intern(bytes, name);
+  } else {
+    blob = std::make_shared<const ObjectBlob>(
+        ObjectBlob{0, name, std::vector<uint8_t>(bytes.begin(), bytes.end())});
+  }
+  return std::make_shared<BpfObject>(std::move(blob), cache, structs);
+}
+
+void BpfObject::clear_cache() { ObjectCache::instance().clear(); }
+
+py::dict BpfObject::get_cache_stats() {
+  return ObjectCache::instance().get_stats();
+}
 
 BpfObject::~BpfObject() {
+  // Parsers may outlive us inside perf/ring buffers; BTF goes with obj_
+  if (struct_parser_) {
+    struct_parser_->set_btf(nullptr);
+  }
+
   // Clear caches first (order matters!)
   prog_cache_.clear(); // Detaches programs
   maps_cache_.clear(); // Closes maps
@@ -27,10 +128,13 @@ BpfObject::BpfObject(BpfObject &&other) noexcept
     : obj_(std::exchange(other.obj_, nullptr)),
       object_path_(std::move(other.object_path_)),
       loaded_(std::exchange(other.loaded_, false)),
+      blob_(std::move(other.blob_)), use_cache_(other.use_cache_),
+      multi_attach_(other.multi_attach_),
       maps_cache_(std::move(other.maps_cache_)),
       prog_cache_(std::move(other.prog_cache_)),
       struct_defs_(std::move(other.struct_defs_)),
-      struct_parser_(std::move(other.struct_parser_)) {
+      struct_parser_(std::move(other.struct_parser_)),
+      decode_structs_(std::move(other.decode_structs_)) {
 
   other.obj_ = nullptr;
   other.loaded_ = false;
@@ -38,6 +142,9 @@ BpfObject::BpfObject(BpfObject &&other) noexcept
 
 BpfObject &BpfObject::operator=(BpfObject &&other) noexcept {
   if (this != &other) {
+    if (struct_parser_) {
+      struct_parser_->set_btf(nullptr);
+    }
     prog_cache_.clear();
     maps_cache_.clear();
     if (obj_) {
@@ -47,36 +154,235 @@ BpfObject &BpfObject::operator=(BpfObject &&other) noexcept {
     obj_ = std::exchange(other.obj_, nullptr);
     object_path_ = std::move(other.object_path_);
     loaded_ = std::exchange(other.loaded_, false);
+    blob_ = std::move(other.blob_);
+    use_cache_ = other.use_cache_;
+    multi_attach_ = other.multi_attach_;
     maps_cache_ = std::move(other.maps_cache_);
     prog_cache_ = std::move(other.prog_cache_);
     struct_defs_ = std::move(other.struct_defs_);
     struct_parser_ = std::move(other.struct_parser_);
+    decode_structs_ = std::move(other.decode_structs_);
   }
   return *this;
 }
 
+std::string BpfObject::source() const {
+  if (!blob_) {
+    return "file '" + object_path_ + "'";
+  }
+  return blob_->name.empty() ? "in-memory image"
+                             : "in-memory image '" + blob_->name + "'";
+}
+
+void BpfObject::open() {
+  if (obj_) {
+    throw BpfException("BPF object already opened");
+  }
+
+  if (!blob_) {
+    obj_ = bpf_object__open_file(object_path_.c_str(), nullptr);
+  } else if (use_cache_) {
+    obj_ = ObjectCache::instance().open(blob_);
+  } else {
+    obj_ = ObjectCache::open_blob(*blob_);
+  }
+
+  if (!obj_) {
+    throw BpfException("Failed to open BPF object from " + source() + ": " +
+                       std::strerror(errno));
+  }
+
+  if (struct_parser_) {
+    struct_parser_->set_btf(bpf_object__btf(obj_));
+  }
+}
+
 void BpfObject::load() {
   if (loaded_) {
     throw BpfException("BPF object already loaded");
   }
 
-  std::string error_msg = "Failed to open BPF object";
-  obj_ = bpf_object__open_file(object_path_.c_str(), nullptr);
-
   if (!obj_) {
-    error_msg += " file '" + object_path_ + "': " + std::strerror(errno);
-    throw BpfException(error_msg);
+    open();
+  }
+
+  if (multi_attach_) {
+    struct bpf_program *prog = nullptr;
+    bpf_object__for_each_program(prog, obj_) {
+      BpfProgram::prepare_multi_attach(prog);
+    }
+  }
+
+  // Plans only need the BTF, so a bad name fails before the kernel load
+  if (!decode_structs_.empty()) {
+    auto parser = get_struct_parser();
+    for (const auto &name : decode_structs_) {
+      parser->prepare(name);
+    }
   }
 
   if (bpf_object__load(obj_)) {
-    error_msg +=
-        " object from file '" + object_path_ + "': " + std::strerror(errno);
+    std::string error_msg = "Failed to load BPF object from " + source() +
+                            ": " + std::strerror(errno);
+    if (struct_parser_) {
+      struct_parser_->set_btf(nullptr);
+    }
     bpf_object__close(obj_);
     obj_ = nullptr;
     throw BpfException(error_msg);
   }
 
   loaded_ = true;
+
+  if (struct_parser_) {
+    struct_parser_->set_btf(bpf_object__btf(obj_));
+  }
+}
+
+// ==================== Configuration Methods ====================
+
+void BpfObject::check_configurable(const std::string &what) const {
+  if (!obj_) {
+    throw BpfException("BPF object not opened; call open() before trying to " +
+                       what);
+  }
+  if (loaded_) {
+    throw BpfException("Cannot " + what + " after the BPF object is loaded");
+  }
+}
+
+void BpfObject::set_max_entries(const std::string &map_name,
+                                __u32 max_entries) {
+  check_configurable("resize map '" + map_name + "'");
+
+  const int ret =
+      bpf_map__set_max_entries(find_map_by_name(map_name), max_entries);
+  if (ret) {
+    throw BpfException("Failed to set max_entries of map '" + map_name +
+                       "': " + std::strerror(-ret));
+  }
+}
+
+void BpfObject::set_autoload(const std::string &prog_name, bool autoload) {
+  check_configurable("change autoload of program '" + prog_name + "'");
+
+  const int ret =
+      bpf_program__set_autoload(find_program_by_name(prog_name), autoload);
+  if (ret) {
+    throw BpfException("Failed to set autoload of program '" + prog_name +
+                       "': " + std::strerror(-ret));
+  }
+}
+
+void BpfObject::set_pin_path(const std::string &map_name,
+                             const std::string &path) {
+  check_configurable("set pin path of map '" + map_name + "'");
+
+  const int ret = bpf_map__set_pin_path(find_map_by_name(map_name),
+                                        path.empty() ? nullptr : path.c_str());
+  if (ret) {
+    throw BpfException("Failed to set pin path of map '" + map_name +
+                       "': " + std::strerror(-ret));
+  }
+}
+
+void BpfObject::set_pin_root(const std::string &dir) {
+  check_configurable("set the pin root");
+
+  struct bpf_map *map = nullptr;
+  bpf_object__for_each_map(map, obj_) {
+    // .data/.rodata/.bss are per-object and re-initialized on every load
+    if (bpf_map__is_internal(map)) {
+      continue;
+    }
+    const std::string path = dir + "/" + bpf_map__name(map);
+    const int ret = bpf_map__set_pin_path(map, path.c_str());
+    if (ret) {
+      throw BpfException("Failed to set pin path '" + path +
+                         "': " + std::strerror(-ret));
+    }
+  }
+}
+
+void BpfObject::reuse_map(const std::string &map_name,
+                          const std::shared_ptr<BpfMap> &source) {
+  check_configurable("reuse a map for '" + map_name + "'");
+
+  // The source's bpf_map, and its fd, belong to its parent object
+  if (!source || !source->get_parent() || source->get_fd() < 0) {
+    throw BpfException("Source map for '" + map_name + "' is not loaded");
+  }
+
+  struct bpf_map *map = find_map_by_name(map_name);
+  auto mismatch = [&](const std::string &what, long ours, long theirs) {
+    throw BpfException("Cannot reuse map '" + source->get_name() + "' as '" +
+                       map_name + "': " + what + " " + std::to_string(theirs) +
+                       " != " + std::to_string(ours));
+  };
+  if (static_cast<int>(bpf_map__type(map)) != source->get_type()) {
+    mismatch("type", bpf_map__type(map), source->get_type());
+  }
+  if (static_cast<int>(bpf_map__key_size(map)) != source->get_key_size()) {
+    mismatch("key size", bpf_map__key_size(map), source->get_key_size());
+  }
+  if (static_cast<int>(bpf_map__value_size(map)) != source->get_value_size()) {
+    mismatch("value size", bpf_map__value_size(map), source->get_value_size());
+  }
+
+  // libbpf dups the fd and adopts the source's definition, max_entries
+  // included
+  const int ret = bpf_map__reuse_fd(map, source->get_fd());
+  if (ret) {
+    throw BpfException("Failed to reuse map '" + source->get_name() +
+                       "' as '" + map_name + "': " + std::strerror(-ret));
+  }
+}
+
+void BpfObject::set_multi_attach(bool enable) {
+  check_configurable("change the attach mode");
+  multi_attach_ = enable;
+}
+
+void BpfObject::set_decode_structs(const py::list &names) {
+  check_configurable("set the decoded structs");
+
+  decode_structs_.clear();
+  for (auto name : names) {
+    decode_structs_.push_back(name.cast<std::string>());
+  }
+}
+
+void BpfObject::set_global(const std::string &name, const py::object &value) {
+  // .rodata is frozen at load and the rest is reachable through its map
+  check_configurable("set global '" + name + "'");
+
+  const GlobalVar var = find_global(obj_, name);
+  size_t size = 0;
+  auto *data = static_cast<uint8_t *>(bpf_map__initial_value(var.map, &size));
+  if (!data || var.offset + var.size > size) {
+    throw BpfException("No initial value for global '" + name + "'");
+  }
+
+  BtfCodec codec(bpf_object__btf(obj_), var.type_id);
+  codec.encode(value, data + var.offset, var.size);
+}
+
+py::object BpfObject::get_global(const std::string &name) const {
+  if (!obj_) {
+    throw BpfException("BPF object not opened");
+  }
+
+  const GlobalVar var = find_global(obj_, name);
+  size_t size = 0;
+  auto *data =
+      static_cast<const uint8_t *>(bpf_map__initial_value(var.map, &size));
+  if (!data || var.offset + var.size > size) {
+    throw BpfException("No initial value for global '" + name + "'");
+  }
+
+  BtfCodec codec(bpf_object__btf(obj_), var.type_id);
+  return codec.decode(data + var.offset, var.size, StructFormat::NamedTuple,
+                      true);
 }
 
 // ==================== Program Methods ====================
@@ -141,8 +447,8 @@ std::shared_ptr<BpfProgram> BpfObject::get_program(const std::string &name) {
 
 struct bpf_program *
 BpfObject::find_program_by_name(const std::string &name) const {
-  if (!loaded_) {
-    throw BpfException("BPF object not loaded");
+  if (!obj_) {
+    throw BpfException("BPF object not opened");
   }
 
   struct bpf_program *prog =
@@ -171,6 +477,11 @@ py::dict BpfObject::attach_all() {
   struct bpf_program *prog = nullptr;
 
   bpf_object__for_each_program(prog, obj_) {
+    // Programs disabled with set_autoload() were never loaded
+    if (!bpf_program__autoload(prog)) {
+      continue;
+    }
+
     auto bpf_prog = _get_or_create_program(prog);
 
     if (!bpf_prog->is_attached()) {
@@ -184,6 +495,94 @@ py::dict BpfObject::attach_all() {
   return attached_programs;
 }
 
+py::dict BpfObject::attach_all_parallel(unsigned max_threads) {
+  if (!loaded_) {
+    throw BpfException("BPF object not loaded");
+  }
+
+  std::vector<std::shared_ptr<BpfProgram>> pending;
+  // Indices into `pending`: the first program of each attach kind, then
+  // everything else
+  std::vector<size_t> first_of_kind, rest;
+  std::unordered_set<std::string> kinds;
+  struct bpf_program *prog = nullptr;
+  bpf_object__for_each_program(prog, obj_) {
+    if (!bpf_program__autoload(prog)) {
+      continue;
+    }
+    auto bpf_prog = _get_or_create_program(prog);
+    if (bpf_prog->is_attached()) {
+      continue;
+    }
+
+    const std::string section = bpf_program__section_name(prog);
+    const std::string kind =
+        section.substr(0, section.find('/')) + ":" +
+        std::to_string(bpf_program__expected_attach_type(prog));
+    if (kinds.insert(kind).second) {
+      first_of_kind.push_back(pending.size());
+    } else {
+      rest.push_back(pending.size());
+    }
+    pending.push_back(std::move(bpf_prog));
+  }
+
+  // libbpf is not documented as thread-safe within one object. What it
+  // shares between attaches is the lazily filled kernel feature cache
+  // (perf links, PMU vs. legacy kprobes, multi links), which is probed on
+  // the first attach of each kind. Those run alone first; after that an
+  // attach only opens perf events/links, resolves its own symbol (the
+  // kernel looks up kprobe names, uprobes parse their own ELF handle) and
+  // names legacy tracefs events from an atomic counter, none of which
+  // touches shared state.
+  std::vector<AttachResult> results(pending.size());
+  {
+    py::gil_scoped_release release;
+
+    for (size_t i : first_of_kind) {
+      results[i] = pending[i]->attach_native();
+    }
+
+    if (max_threads == 0) {
+      max_threads = std::max(1U, std::thread::hardware_concurrency());
+    }
+    const size_t num_threads =
+        std::min<size_t>(max_threads, std::max<size_t>(rest.size(), 1));
+
+    std::atomic<size_t> next{0};
+    auto worker = [&] {
+      for (size_t n = next++; n < rest.size(); n = next++) {
+        results[rest[n]] = pending[rest[n]]->attach_native();
+      }
+    };
+
+    std::vector<std::thread> pool;
+    for (size_t t = 1; t < num_threads; ++t) {
+      pool.emplace_back(worker);
+    }
+    worker();
+    for (auto &thread : pool) {
+      thread.join();
+    }
+  }
+
+  py::dict report;
+  for (size_t i = 0; i < pending.size(); ++i) {
+    const AttachResult &result = results[i];
+    py::dict entry;
+    entry["ok"] = result.err == 0;
+    if (result.err) {
+      entry["error"] = std::strerror(-result.err);
+    } else {
+      entry["error"] = py::none();
+    }
+    entry["elapsed_us"] = result.elapsed_us;
+    entry["method"] = result.method;
+    report[pending[i]->get_name().c_str()] = entry;
+  }
+  return report;
+}
+
 // ==================== Map Methods ====================
 
 py::list BpfObject::get_map_names() {
@@ -243,8 +642,8 @@ std::shared_ptr<BpfMap> BpfObject::_get_or_create_map(struct bpf_map *map) {
 }
 
 struct bpf_map *BpfObject::find_map_by_name(const std::string &name) const {
-  if (!loaded_) {
-    throw BpfException("BPF object not loaded");
+  if (!obj_) {
+    throw BpfException("BPF object not opened");
   }
 
   struct bpf_map *map = bpf_object__find_map_by_name(obj_, name.c_str());
@@ -264,9 +663,10 @@ py::dict BpfObject::get_cached_maps() const {
 }
 
 std::shared_ptr<StructParser> BpfObject::get_struct_parser() const {
-  if (!struct_parser_ && !struct_defs_.empty()) {
-    // Create parser on first access
-    struct_parser_ = std::make_shared<StructParser>(struct_defs_);
+  if (!struct_parser_ && (obj_ || !struct_defs_.empty())) {
+    // Create parser on first access; BTF covers structs without ctypes
+    struct_parser_ = std::make_shared<StructParser>(
+        struct_defs_, obj_ ? bpf_object__btf(obj_) : nullptr);
   }
   return struct_parser_;
 }
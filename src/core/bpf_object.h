@@ -6,12 +6,14 @@
 #include <pybind11/pybind11.h>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 namespace py = pybind11;
 
 class BpfProgram;
 class BpfMap;
 class StructParser;
+struct ObjectBlob;
 
 /**
  * BpfObject - Represents a loaded BPF object file.
@@ -24,18 +26,29 @@ private:
   struct bpf_object *obj_;
   std::string object_path_;
   bool loaded_;
+  // Set when opened from memory; libbpf may reference it until close
+  std::shared_ptr<const ObjectBlob> blob_;
+  bool use_cache_;
+  bool multi_attach_;
 
   mutable std::unordered_map<std::string, std::shared_ptr<BpfMap>> maps_cache_;
   mutable std::unordered_map<std::string, std::shared_ptr<BpfProgram>>
       prog_cache_;
   py::dict struct_defs_;
   mutable std::shared_ptr<StructParser> struct_parser_;
+  // BTF structs whose decode plans are compiled by load()
+  std::vector<std::string> decode_structs_;
 
   std::shared_ptr<BpfProgram> _get_or_create_program(struct bpf_program *prog);
   std::shared_ptr<BpfMap> _get_or_create_map(struct bpf_map *map);
+  void check_configurable(const std::string &what) const;
+  // Where the object came from, for error messages
+  [[nodiscard]] std::string source() const;
 
 public:
   explicit BpfObject(std::string object_path, py::dict structs = py::dict());
+  BpfObject(std::shared_ptr<const ObjectBlob> blob, bool use_cache,
+            py::dict structs = py::dict());
   ~BpfObject();
 
   // Disable copy, allow move
@@ -45,16 +58,72 @@ public:
   BpfObject &operator=(BpfObject &&) noexcept;
 
   /**
-   * Load the BPF object into the kernel.
+   * Create an object from an in-memory ELF image. With `cache`, equal
+   * images share one copy and repeat instances reuse a pre-parsed object.
+   */
+  static std::shared_ptr<BpfObject> from_bytes(const py::buffer &data,
+                                               const std::string &name = "",
+                                               py::dict structs = py::dict(),
+                                               bool cache = false);
+  static void clear_cache();
+  [[nodiscard]] static py::dict get_cache_stats();
+
+  /**
+   * Parse the object file without loading it. Between open() and load()
+   * maps can be resized, programs disabled and globals specialized.
+   */
+  void open();
+
+  /**
+   * Load the BPF object into the kernel, opening it first if needed.
    * Must be called before accessing programs or maps.
    */
   void load();
 
   /**
-   * Check if object is loaded.
+   * Check if object is opened / loaded.
    */
+  [[nodiscard]] bool is_opened() const { return obj_ != nullptr; }
   [[nodiscard]] bool is_loaded() const { return loaded_; }
 
+  // Pre-load configuration (between open() and load())
+  void set_max_entries(const std::string &map_name, __u32 max_entries);
+  void set_autoload(const std::string &prog_name, bool autoload);
+  /**
+   * Pin maps at `path` (or `<dir>/<map name>` for every non-internal map).
+   * At load an existing compatible pin is reused with its contents,
+   * otherwise the new map is pinned there.
+   */
+  void set_pin_path(const std::string &map_name, const std::string &path);
+  void set_pin_root(const std::string &dir);
+  /**
+   * Make map `map_name` share the kernel map behind `source`, typically a
+   * map of another loaded object, instead of creating its own. The fd is
+   * duplicated, so the map lives on while any object still uses it.
+   */
+  void reuse_map(const std::string &map_name,
+                 const std::shared_ptr<BpfMap> &source);
+  /**
+   * Load plain kprobes/uprobes as multi-attach programs where possible.
+   * Such programs can only attach through multi links (kprobe_multi since
+   * Linux 5.18, uprobe_multi since 6.6); there is no perf-event fallback.
+   */
+  void set_multi_attach(bool enable);
+  /**
+   * Name the BTF structs consumers will decode. load() compiles their
+   * decode plans (and rejects unknown names) before the object is loaded,
+   * so no consumer pays for the BTF walk later.
+   */
+  void set_decode_structs(const py::list &names);
+
+  /**
+   * Typed access to global variables (.rodata, .data, .bss) through their
+   * BTF. Writing a .rodata constant before load lets the verifier prune
+   * the branches it disables.
+   */
+  void set_global(const std::string &name, const py::object &value);
+  [[nodiscard]] py::object get_global(const std::string &name) const;
+
   /**
    * Get the underlying bpf_object pointer.
    * Only for internal use by BpfProgram and BpfMap.
@@ -66,6 +135,13 @@ public:
    */
   py::dict attach_all();
 
+  /**
+   * Attach all programs on up to `max_threads` threads (0: one per CPU)
+   * without stopping at the first failure. Returns a report of
+   * {name: {"ok", "error", "elapsed_us", "method"}}.
+   */
+  py::dict attach_all_parallel(unsigned max_threads = 0);
+
   // Program access
   [[nodiscard]] py::list get_program_names();
   [[nodiscard]] std::shared_ptr<BpfProgram>
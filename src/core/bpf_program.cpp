@@ -1,10 +1,126 @@
 #include "core/bpf_program.h"
 #include "core/bpf_exception.h"
 #include "core/bpf_object.h"
+#include <algorithm>
+#include <bpf.h>
 #include <cerrno>
+#include <chrono>
 #include <cstring>
+#include <string_view>
+#include <unistd.h>
 #include <utility>
 
+namespace {
+
+struct ProbeTarget {
+  enum bpf_attach_type multi_type;
+  bool retprobe;
+  std::string binary, func;
+};
+
+bool consume_prefix(std::string_view &str, std::string_view prefix) {
+  if (str.substr(0, prefix.size()) != prefix)
+    return false;
+  str.remove_prefix(prefix.size());
+  return true;
+}
+
+// Kernel link type of `link_fd`, or BPF_LINK_TYPE_UNSPEC if unknown
+__u32 link_type(int link_fd) {
+  bpf_link_info info{};
+  __u32 len = sizeof(info);
+  if (bpf_link_get_info_by_fd(link_fd, &info, &len))
+    return BPF_LINK_TYPE_UNSPEC;
+  return info.type;
+}
+
+// Why the link at `link_fd` cannot be taken over by `prog`, or "" if it
+// can. The program type must match; the attach point is compared where
+// the kernel reports it, and by program name for links (perf events)
+// whose info does not carry it.
+std::string link_mismatch(int link_fd, const bpf_program *prog) {
+  char tp_name[256] = {};
+  bpf_link_info link_info{};
+  __u32 len = sizeof(link_info);
+  link_info.raw_tracepoint.tp_name = reinterpret_cast<__u64>(tp_name);
+  link_info.raw_tracepoint.tp_name_len = sizeof(tp_name);
+  if (bpf_link_get_info_by_fd(link_fd, &link_info, &len))
+    return std::string("cannot query the link: ") + std::strerror(errno);
+  if (link_info.type != BPF_LINK_TYPE_RAW_TRACEPOINT)
+    tp_name[0] = '\0';
+
+  const int prog_fd = bpf_prog_get_fd_by_id(link_info.prog_id);
+  if (prog_fd < 0)
+    return std::string("cannot open its program: ") + std::strerror(errno);
+  bpf_prog_info prog_info{};
+  len = sizeof(prog_info);
+  const int ret = bpf_prog_get_info_by_fd(prog_fd, &prog_info, &len);
+  const int err = errno;
+  close(prog_fd);
+  if (ret)
+    return std::string("cannot query its program: ") + std::strerror(err);
+
+  if (prog_info.type != static_cast<__u32>(bpf_program__type(prog))) {
+    return "it runs a program of type " + std::to_string(prog_info.type) +
+           ", not " + std::to_string(bpf_program__type(prog));
+  }
+
+  const auto attach_type =
+      static_cast<__u32>(bpf_program__expected_attach_type(prog));
+  switch (link_info.type) {
+  case BPF_LINK_TYPE_RAW_TRACEPOINT: {
+    std::string_view target(bpf_program__section_name(prog));
+    target.remove_prefix(std::min(target.size(), target.find('/') + 1));
+    if (target != tp_name)
+      return std::string("it is attached to raw tracepoint '") + tp_name + "'";
+    return "";
+  }
+  case BPF_LINK_TYPE_TRACING:
+    if (link_info.tracing.attach_type != attach_type)
+      return "it has attach type " +
+             std::to_string(link_info.tracing.attach_type);
+    return "";
+  case BPF_LINK_TYPE_CGROUP:
+    if (link_info.cgroup.attach_type != attach_type)
+      return "it has attach type " +
+             std::to_string(link_info.cgroup.attach_type);
+    return "";
+  default: {
+    const std::string name =
+        std::string(bpf_program__name(prog)).substr(0, BPF_OBJ_NAME_LEN - 1);
+    if (name != prog_info.name)
+      return std::string("it runs program '") + prog_info.name + "'";
+    return "";
+  }
+  }
+}
+
+// Parse the section forms libbpf auto-attaches as single kprobes/uprobes.
+// Offsets ("func+0x10") have no multi-link equivalent and are left alone.
+bool parse_probe_section(const char *section, ProbeTarget &target) {
+  std::string_view sec(section ? section : "");
+  if (consume_prefix(sec, "kprobe/") || consume_prefix(sec, "kretprobe/")) {
+    if (sec.empty() || sec.find('+') != std::string_view::npos)
+      return false;
+    target = {BPF_TRACE_KPROBE_MULTI, section[1] == 'r', "", std::string(sec)};
+    return true;
+  }
+  if (consume_prefix(sec, "uprobe/") || consume_prefix(sec, "uretprobe/")) {
+    const size_t colon = sec.rfind(':');
+    if (colon == std::string_view::npos || colon == 0 ||
+        colon + 1 == sec.size() ||
+        sec.find('+', colon) != std::string_view::npos)
+      return false;
+    target = {BPF_TRACE_UPROBE_MULTI, section[1] == 'r',
+              std::string(sec.substr(0, colon)),
+              std::string(sec.substr(colon + 1))};
+    return true;
+  }
+  return false;
+}
+
+} // namespace
+
 BpfProgram::BpfProgram(std::shared_ptr<BpfObject> parent,
                        struct bpf_program *raw_prog,
                        const std::string &program_name)
@@ -58,17 +174,127 @@ void BpfProgram::attach() {
     throw BpfException("Program '" + program_name_ + "' not initialized");
   }
 
-  link_ = bpf_program__attach(prog_);
-  if (!link_) {
-    std::string err_msg = "bpf_program__attach failed for program '" +
-                          program_name_ + "': " + std::strerror(errno);
+  const AttachResult result = attach_native();
+  if (result.err) {
+    std::string err_msg = result.method + " failed for program '" +
+                          program_name_ + "': " + std::strerror(-result.err);
     throw BpfException(err_msg);
   }
 }
 
+AttachResult BpfProgram::attach_native() {
+  const auto start = std::chrono::steady_clock::now();
+  AttachResult result{0, "bpf_program__attach", 0};
+
+  ProbeTarget target;
+  const enum bpf_attach_type type = bpf_program__expected_attach_type(prog_);
+  if ((type == BPF_TRACE_KPROBE_MULTI || type == BPF_TRACE_UPROBE_MULTI) &&
+      parse_probe_section(bpf_program__section_name(prog_), target) &&
+      target.multi_type == type) {
+    // Loaded with the multi attach type, the program cannot be attached
+    // through a perf event any more, so there is nothing to fall back to
+    const char *syms[] = {target.func.c_str()};
+    if (type == BPF_TRACE_KPROBE_MULTI) {
+      result.method = "kprobe_multi";
+      LIBBPF_OPTS(bpf_kprobe_multi_opts, opts, .syms = syms, .cnt = 1,
+                  .retprobe = target.retprobe);
+      link_ = bpf_program__attach_kprobe_multi_opts(prog_, nullptr, &opts);
+    } else {
+      result.method = "uprobe_multi";
+      LIBBPF_OPTS(bpf_uprobe_multi_opts, opts, .retprobe = target.retprobe);
+      link_ = bpf_program__attach_uprobe_multi(
+          prog_, -1, target.binary.c_str(), target.func.c_str(), &opts);
+    }
+  } else {
+    link_ = bpf_program__attach(prog_);
+  }
+  if (!link_)
+    result.err = -errno;
+
+  result.elapsed_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                          std::chrono::steady_clock::now() - start)
+                          .count();
+  return result;
+}
+
+bool BpfProgram::prepare_multi_attach(struct bpf_program *prog) {
+  ProbeTarget target;
+  if (!parse_probe_section(bpf_program__section_name(prog), target))
+    return false;
+  return bpf_program__set_expected_attach_type(prog, target.multi_type) == 0;
+}
+
 void BpfProgram::detach() {
   if (link_) {
+    // A pinned link outlives our fd. Perf-event links still go through
+    // libbpf's detach so their perf event fd is closed too; the kernel
+    // link holds its own reference to the event. Other kinds are
+    // disconnected so no detach hook can touch the attachment.
+    if (bpf_link__pin_path(link_) &&
+        link_type(bpf_link__fd(link_)) != BPF_LINK_TYPE_PERF_EVENT) {
+      bpf_link__disconnect(link_);
+      close(bpf_link__fd(link_));
+    }
     bpf_link__destroy(link_);
     link_ = nullptr;
   }
 }
+
+void BpfProgram::pin_link(const std::string &path) {
+  if (!link_) {
+    throw BpfException("Program '" + program_name_ + "' is not attached");
+  }
+
+  const int ret = bpf_link__pin(link_, path.c_str());
+  if (ret) {
+    throw BpfException("Failed to pin link of program '" + program_name_ +
+                       "' at '" + path + "': " + std::strerror(-ret));
+  }
+}
+
+void BpfProgram::unpin_link() {
+  if (!link_ || !bpf_link__pin_path(link_)) {
+    throw BpfException("Program '" + program_name_ + "' has no pinned link");
+  }
+
+  const int ret = bpf_link__unpin(link_);
+  if (ret) {
+    throw BpfException("Failed to unpin link of program '" + program_name_ +
+                       "': " + std::strerror(-ret));
+  }
+}
+
+void BpfProgram::adopt_link(const std::string &path, bool replace) {
+  if (link_) {
+    throw BpfException("Program '" + program_name_ + "' already attached");
+  }
+
+  link_ = bpf_link__open(path.c_str());
+  if (!link_) {
+    throw BpfException("Failed to open pinned link '" + path +
+                       "' for program '" + program_name_ +
+                       "': " + std::strerror(errno));
+  }
+
+  const std::string mismatch = link_mismatch(bpf_link__fd(link_), prog_);
+  if (!mismatch.empty()) {
+    detach();
+    throw BpfException("Pinned link '" + path + "' does not match program '" +
+                       program_name_ + "': " + mismatch);
+  }
+
+  if (replace) {
+    const int ret = bpf_link__update_program(link_, prog_);
+    if (ret) {
+      // Leave the pinned link running the old program
+      detach();
+      throw BpfException("Failed to replace the program of link '" + path +
+                         "' with '" + program_name_ +
+                         "': " + std::strerror(-ret));
+    }
+  }
+}
+
+bool BpfProgram::is_link_pinned() const {
+  return link_ && bpf_link__pin_path(link_);
+}
@@ -1,12 +1,20 @@
 #ifndef PYLIBBPF_BPF_PROGRAM_H
 #define PYLIBBPF_BPF_PROGRAM_H
 
+#include <cstdint>
 #include <libbpf.h>
 #include <memory>
 #include <string>
 
 class BpfObject;
 
+// Outcome of one attach attempt; err is 0 or a negative errno
+struct AttachResult {
+  int err;
+  std::string method;
+  uint64_t elapsed_us;
+};
+
 class BpfProgram {
 private:
   std::weak_ptr<BpfObject> parent_obj_;
@@ -27,8 +35,37 @@ public:
   BpfProgram &operator=(BpfProgram &&) noexcept;
 
   void attach();
+  // Drops our handle; a pinned link stays attached until it is unpinned
   void detach();
 
+  /**
+   * Link pinning. A pinned link keeps the program attached across
+   * restarts; the next process takes it over with adopt_link() instead
+   * of attaching again. An adopted link keeps running the program of the
+   * process that pinned it unless `replace` swaps in this program, which
+   * upgrades the code in place without a detach window. A link whose
+   * program type or attach point differs from this program is refused.
+   */
+  void pin_link(const std::string &path);
+  void unpin_link();
+  void adopt_link(const std::string &path, bool replace = false);
+  [[nodiscard]] bool is_link_pinned() const;
+
+  /**
+   * Attach without raising or touching Python, so it can run on a worker
+   * thread. Programs converted by prepare_multi_attach() go through a
+   * kprobe/uprobe multi link only; a failure is reported with method
+   * "kprobe_multi"/"uprobe_multi".
+   */
+  AttachResult attach_native();
+
+  /**
+   * Before load: switch a plain "kprobe/<func>" or "uprobe/<path>:<func>"
+   * program to the multi-attach type, skipping per-probe perf events.
+   * Returns false if the section is not eligible.
+   */
+  static bool prepare_multi_attach(struct bpf_program *prog);
+
   [[nodiscard]] bool is_attached() const { return link_ != nullptr; }
   [[nodiscard]] std::string get_name() const { return program_name_; }
 };
@@ -0,0 +1,26 @@
+#ifndef PYLIBBPF_EVENT_SOURCE_H
+#define PYLIBBPF_EVENT_SOURCE_H
+
+#include <cstddef>
+
+/**
+ * EventSource - Anything a Poller can wait on and drain.
+ *
+ * Implemented by PerfEventArray and RingBuffer.
+ */
+class EventSource {
+public:
+  virtual ~EventSource() = default;
+
+  // Readable whenever the source has pending events
+  [[nodiscard]] virtual int epoll_fd() const = 0;
+
+  /**
+   * Deliver up to `budget` events to the callbacks (0 = everything
+   * pending). Called with the GIL released; callbacks take it themselves.
+   * Returns the number of events delivered or a negative errno.
+   */
+  virtual int consume_budget(size_t budget) = 0;
+};
+
+#endif // PYLIBBPF_EVENT_SOURCE_H
@@ -2,14 +2,33 @@
 #include "core/bpf_exception.h"
 #include "core/bpf_map.h"
 #include "core/bpf_object.h"
+#include "utils/column_batch.h"
+#include "utils/event_recorder.h"
+#include "utils/event_view.h"
 #include "utils/struct_parser.h"
+#include <algorithm>
 #include <cerrno>
 #include <cstring>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+namespace {
+
+uint64_t elapsed_ns(std::chrono::steady_clock::time_point start,
+                    std::chrono::steady_clock::time_point end) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
+      .count();
+}
+
+} // namespace
 
 PerfEventArray::PerfEventArray(std::shared_ptr<BpfMap> map, int page_cnt,
                                py::function callback, py::object lost_callback)
-    : map_(map), pb_(nullptr), callback_(std::move(callback)),
-      lost_callback_(std::move(lost_callback)) {
+    : map_(map), claim_(*map), pb_(nullptr), callback_(std::move(callback)),
+      lost_callback_(std::move(lost_callback)), max_batch_size_(0),
+      flush_latency_(0), zero_copy_(false), stats_(libbpf_num_possible_cpus()),
+      deliver_recorded_(false), delivered_(0), next_buffer_(0),
+      worker_mode_(false), workers_stop_(false), worker_lost_(0) {
 
   if (map->get_type() != BPF_MAP_TYPE_PERF_EVENT_ARRAY) {
     throw BpfException("Map '" + map->get_name() +
@@ -26,7 +45,7 @@ PerfEventArray::PerfEventArray(std::shared_ptr<BpfMap> map, int page_cnt,
   pb_ = perf_buffer__new(
       map->get_fd(), page_cnt,
       sample_callback_wrapper,                                   // sample_cb
-      lost_callback.is_none() ? nullptr : lost_callback_wrapper, // lost_cb
+      lost_callback_wrapper,                                     // lost_cb
       this,                                                      // ctx
       &pb_opts                                                   // opts
   );
@@ -52,11 +71,15 @@ PerfEventArray::PerfEventArray(std::shared_ptr<BpfMap> map, int page_cnt,
   struct_name_ = struct_name;
 
   if (!parser_) {
-    throw BpfException("No struct definitions available");
+    throw BpfException("Unknown struct: " + struct_name_);
   }
+  // Compile the decode plan now rather than on the first sample
+  parser_->prepare(struct_name_);
 }
 
 PerfEventArray::~PerfEventArray() {
+  stop_workers();
+
   if (pb_) {
     perf_buffer__free(pb_);
   }
@@ -66,30 +89,228 @@ void PerfEventArray::sample_callback_wrapper(void *ctx, int cpu, void *data,
                                              unsigned int size) {
   auto *self = static_cast<PerfEventArray *>(ctx);
 
+  if (self->filter_ && !self->filter_->admit(*self->predicate_, data, size)) {
+    return;
+  }
+  self->stats_.record_sample(cpu, size);
+  // Recorded-only samples count too, so consume_budget() still stops.
+  // Reader threads never run consume_budget(), and must not race on this.
+  if (!self->worker_mode_) {
+    ++self->delivered_;
+  }
+
+  if (self->recorder_) {
+    self->recorder_->append(cpu, data, size);
+    if (!self->deliver_recorded_) {
+      return;
+    }
+  }
+
+  if (self->worker_mode_) {
+    // Running on a reader thread, never touch Python here
+    self->queue_->push(cpu, data, size);
+    return;
+  }
+
+  if (self->max_batch_size_ > 0 || self->columns_) {
+    // Stash the sample without touching Python
+    auto now = std::chrono::steady_clock::now();
+    if (self->batch_samples_.empty())
+      self->batch_started_ = now;
+
+    const size_t offset = self->batch_data_.size();
+    const auto *bytes = static_cast<const uint8_t *>(data);
+    self->batch_data_.insert(self->batch_data_.end(), bytes, bytes + size);
+    self->batch_samples_.push_back({cpu, offset, size});
+
+    if ((self->max_batch_size_ > 0 &&
+         self->batch_samples_.size() >= self->max_batch_size_) ||
+        (self->flush_latency_.count() > 0 &&
+         now - self->batch_started_ >= self->flush_latency_)) {
+      self->flush_batch();
+    }
+    return;
+  }
+
   // Acquire GIL for Python calls
+  auto wait_start = std::chrono::steady_clock::now();
   py::gil_scoped_acquire acquire;
+  auto decode_start = std::chrono::steady_clock::now();
+  auto callback_start = decode_start;
 
+  std::shared_ptr<EventView> view;
   try {
-    // Convert data to Python bytes
-    py::bytes py_data(static_cast<const char *>(data), size);
-
-    if (self->parser_ && !self->struct_name_.empty()) {
-      py::object event = self->parser_->parse(self->struct_name_, py_data);
-      self->callback_(cpu, event);
+    if (self->zero_copy_) {
+      view = std::make_shared<EventView>(data, size, self->parser_,
+                                         self->struct_name_);
+      callback_start = std::chrono::steady_clock::now();
+      self->callback_(cpu, view);
     } else {
-      self->callback_(cpu, py_data);
+      py::object event = self->make_event(data, size);
+      callback_start = std::chrono::steady_clock::now();
+      self->callback_(cpu, event);
     }
+  } catch (const py::error_already_set &e) {
+    PyErr_Print();
+  } catch (const std::exception &e) {
+    py::print("C++ error in perf callback:", e.what());
+  }
+
+  auto end = std::chrono::steady_clock::now();
+  self->stats_.record_decode(elapsed_ns(decode_start, callback_start));
+  self->stats_.record_callback(elapsed_ns(wait_start, decode_start),
+                               elapsed_ns(callback_start, end));
+
+  // The sample memory is handed back to the kernel once we return
+  if (view) {
+    view->release();
+  }
+}
 
+py::object PerfEventArray::make_event(const void *data, size_t size) {
+  if (parser_ && !struct_name_.empty()) {
+    return parser_->parse_raw(struct_name_, data, size);
+  }
+  return py::bytes(static_cast<const char *>(data), size);
+}
+
+int PerfEventArray::consume_budget(size_t budget) {
+  if (worker_mode_) {
+    throw BpfException("Reader threads are running; use read_events()");
+  }
+
+  const auto poll_start = std::chrono::steady_clock::now();
+  const size_t buffers = perf_buffer__buffer_cnt(pb_);
+  const uint64_t start = delivered_;
+  for (size_t i = 0; i < buffers; ++i) {
+    const size_t idx = (next_buffer_ + i) % buffers;
+    const int err = perf_buffer__consume_buffer(pb_, idx);
+    if (err < 0 && err != -ENOENT) {
+      flush_batch();
+      return err;
+    }
+    if (budget && delivered_ - start >= budget) {
+      next_buffer_ = (idx + 1) % buffers;
+      break;
+    }
+  }
+
+  flush_batch();
+  stats_.record_poll(elapsed_ns(poll_start, std::chrono::steady_clock::now()));
+  return static_cast<int>(delivered_ - start);
+}
+
+void PerfEventArray::flush_batch() {
+  if (batch_samples_.empty())
+    return;
+
+  // Column decoding is pure native work, done before taking the GIL
+  auto decode_start = std::chrono::steady_clock::now();
+  std::shared_ptr<ColumnBatch> columns;
+  if (columns_) {
+    columns = std::make_shared<ColumnBatch>(columns_, batch_samples_.size());
+    for (const auto &sample : batch_samples_) {
+      columns->append(sample.cpu, batch_data_.data() + sample.offset,
+                      sample.size);
+    }
+  }
+
+  auto wait_start = std::chrono::steady_clock::now();
+  py::gil_scoped_acquire acquire;
+  auto acquired = std::chrono::steady_clock::now();
+  auto callback_start = acquired;
+
+  try {
+    if (columns) {
+      callback_(columns);
+    } else {
+      py::list batch(batch_samples_.size());
+      for (size_t i = 0; i < batch_samples_.size(); ++i) {
+        const auto &sample = batch_samples_[i];
+        batch[i] = py::make_tuple(
+            sample.cpu,
+            make_event(batch_data_.data() + sample.offset, sample.size));
+      }
+
+      callback_start = std::chrono::steady_clock::now();
+      callback_(batch);
+    }
   } catch (const py::error_already_set &e) {
     PyErr_Print();
   } catch (const std::exception &e) {
     py::print("C++ error in perf callback:", e.what());
   }
+
+  auto end = std::chrono::steady_clock::now();
+  stats_.record_decode(elapsed_ns(decode_start, wait_start) +
+                       elapsed_ns(acquired, callback_start));
+  stats_.record_callback(elapsed_ns(wait_start, acquired),
+                         elapsed_ns(callback_start, end));
+
+  batch_samples_.clear();
+  batch_data_.clear();
+}
+
+void PerfEventArray::set_batching(size_t max_batch_size, int flush_latency_ms) {
+  if (flush_latency_ms < 0) {
+    throw BpfException("flush_latency_ms must not be negative");
+  }
+
+  flush_batch();
+  max_batch_size_ = max_batch_size;
+  flush_latency_ = std::chrono::milliseconds(flush_latency_ms);
+}
+
+void PerfEventArray::set_columnar(bool enabled) {
+  flush_batch();
+
+  if (!enabled) {
+    columns_.reset();
+    return;
+  }
+
+  auto codec = parser_ ? parser_->get_codec(struct_name_) : nullptr;
+  if (!codec) {
+    throw BpfException("Columnar decoding needs a BTF-described struct_name");
+  }
+  columns_ = std::make_shared<ColumnLayout>(*codec);
+}
+
+void PerfEventArray::set_filter(std::shared_ptr<EventFilter> filter) {
+  if (worker_mode_) {
+    throw BpfException("Cannot change the filter while workers are running");
+  }
+
+  if (!filter) {
+    filter_.reset();
+    predicate_.reset();
+    return;
+  }
+
+  predicate_ = filter->bind(parser_.get(), struct_name_);
+  filter_ = std::move(filter);
+}
+
+void PerfEventArray::set_recorder(std::shared_ptr<EventRecorder> recorder,
+                                  bool deliver) {
+  if (worker_mode_) {
+    throw BpfException("Cannot change the recorder while workers are running");
+  }
+
+  flush_batch();
+  recorder_ = std::move(recorder);
+  deliver_recorded_ = deliver;
 }
 
 void PerfEventArray::lost_callback_wrapper(void *ctx, int cpu,
                                            unsigned long long cnt) {
   auto *self = static_cast<PerfEventArray *>(ctx);
+  self->stats_.record_lost(cpu, cnt);
+
+  if (self->worker_mode_) {
+    self->worker_lost_.fetch_add(cnt, std::memory_order_relaxed);
+    return;
+  }
 
   py::gil_scoped_acquire acquire;
 
@@ -106,12 +327,180 @@ void PerfEventArray::lost_callback_wrapper(void *ctx, int cpu,
 }
 
 int PerfEventArray::poll(int timeout_ms) {
-  // Release GIL during blocking poll
-  py::gil_scoped_release release;
-  return perf_buffer__poll(pb_, timeout_ms);
+  if (worker_mode_) {
+    throw BpfException("Reader threads are running; use read_events()");
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  int ret;
+  {
+    // Release GIL during blocking poll
+    py::gil_scoped_release release;
+    ret = perf_buffer__poll(pb_, timeout_ms);
+  }
+  flush_batch();
+  stats_.record_poll(elapsed_ns(start, std::chrono::steady_clock::now()));
+  return ret;
 }
 
 int PerfEventArray::consume() {
-  py::gil_scoped_release release;
-  return perf_buffer__consume(pb_);
+  if (worker_mode_) {
+    throw BpfException("Reader threads are running; use read_events()");
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  int ret;
+  {
+    py::gil_scoped_release release;
+    ret = perf_buffer__consume(pb_);
+  }
+  flush_batch();
+  stats_.record_poll(elapsed_ns(start, std::chrono::steady_clock::now()));
+  return ret;
+}
+
+void PerfEventArray::set_zero_copy(bool enabled) { zero_copy_ = enabled; }
+
+// ==================== Reader Threads ====================
+
+void PerfEventArray::start_workers(size_t num_threads, size_t queue_capacity,
+                                   OverflowPolicy policy, size_t slot_size) {
+  if (worker_mode_) {
+    throw BpfException("Reader threads already running");
+  }
+  if (num_threads == 0) {
+    throw BpfException("num_threads must be positive");
+  }
+
+  flush_batch();
+
+  const size_t buffer_cnt = perf_buffer__buffer_cnt(pb_);
+  num_threads = std::min(num_threads, buffer_cnt);
+
+  // Each thread waits on its own epoll set covering its shard of buffers
+  std::vector<int> epoll_fds;
+  for (size_t i = 0; i < num_threads; ++i) {
+    int epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (epfd < 0) {
+      const int err = errno;
+      for (int fd : epoll_fds)
+        close(fd);
+      throw BpfException("Failed to create epoll instance: " +
+                         std::string(std::strerror(err)));
+    }
+    epoll_fds.push_back(epfd);
+
+    for (size_t idx = i; idx < buffer_cnt; idx += num_threads) {
+      struct epoll_event ev = {};
+      ev.events = EPOLLIN;
+      ev.data.u64 = idx;
+      if (epoll_ctl(epfd, EPOLL_CTL_ADD, perf_buffer__buffer_fd(pb_, idx),
+                    &ev) < 0) {
+        const int err = errno;
+        for (int fd : epoll_fds)
+          close(fd);
+        throw BpfException("Failed to watch perf buffer " +
+                           std::to_string(idx) + ": " + std::strerror(err));
+      }
+    }
+  }
+
+  // A read_events() still waiting on the old queue keeps it alive
+  queue_ = std::make_shared<EventQueue>(queue_capacity, policy, slot_size);
+  worker_lost_.store(0);
+  workers_stop_.store(false);
+  worker_mode_ = true;
+
+  for (size_t i = 0; i < num_threads; ++i) {
+    workers_.emplace_back(&PerfEventArray::worker_loop, this, epoll_fds[i], i,
+                          num_threads);
+  }
+}
+
+void PerfEventArray::worker_loop(int epoll_fd, size_t worker_idx,
+                                 size_t num_workers) {
+  const size_t buffer_cnt = perf_buffer__buffer_cnt(pb_);
+  std::vector<struct epoll_event> events(buffer_cnt / num_workers + 1);
+
+  while (!workers_stop_.load(std::memory_order_acquire)) {
+    const int n = epoll_wait(epoll_fd, events.data(),
+                             static_cast<int>(events.size()), 100);
+    for (int i = 0; i < n; ++i) {
+      perf_buffer__consume_buffer(pb_, events[i].data.u64);
+    }
+  }
+
+  // Pick up whatever arrived before the stop request
+  for (size_t idx = worker_idx; idx < buffer_cnt; idx += num_workers) {
+    perf_buffer__consume_buffer(pb_, idx);
+  }
+
+  close(epoll_fd);
+}
+
+void PerfEventArray::stop_workers() {
+  if (!worker_mode_) {
+    return;
+  }
+
+  workers_stop_.store(true, std::memory_order_release);
+  queue_->close();
+
+  {
+    py::gil_scoped_release release;
+    for (auto &worker : workers_) {
+      worker.join();
+    }
+  }
+
+  workers_.clear();
+  worker_mode_ = false;
+}
+
+py::list PerfEventArray::read_events(size_t max_events, int timeout_ms) {
+  if (!queue_) {
+    throw BpfException("Reader threads were never started");
+  }
+  if (max_events == 0) {
+    throw BpfException("max_events must be positive");
+  }
+
+  // start_workers() may swap in a new queue while we wait without the GIL
+  std::shared_ptr<EventQueue> queue = queue_;
+  std::vector<QueuedEvent> events;
+  {
+    py::gil_scoped_release release;
+    QueuedEvent event;
+    if (queue->pop_wait(event, std::chrono::milliseconds(timeout_ms))) {
+      events.push_back(std::move(event));
+      while (events.size() < max_events && queue->try_pop(event)) {
+        events.push_back(std::move(event));
+      }
+    }
+  }
+
+  py::list result;
+  for (const auto &event : events) {
+    result.append(py::make_tuple(
+        event.cpu, make_event(event.data.data(), event.data.size())));
+  }
+  return result;
+}
+
+py::dict PerfEventArray::get_queue_stats() const {
+  py::dict stats;
+  if (!queue_) {
+    return stats;
+  }
+
+  stats["capacity"] = queue_->capacity();
+  stats["slot_size"] = queue_->slot_size();
+  stats["queued"] = queue_->size();
+  stats["enqueued"] = queue_->enqueued();
+  stats["dropped_oldest"] = queue_->dropped_oldest();
+  stats["dropped_newest"] = queue_->dropped_newest();
+  stats["blocked"] = queue_->blocked();
+  stats["lost"] = worker_lost_.load();
+  stats["running"] = worker_mode_;
+  return stats;
 }
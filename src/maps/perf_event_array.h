@@ -1,19 +1,32 @@
 #ifndef PYLIBBPF_PERF_EVENT_ARRAY_H
 #define PYLIBBPF_PERF_EVENT_ARRAY_H
 
+#include "maps/event_source.h"
+#include "maps/perf_slot_claim.h"
+#include "utils/consumer_stats.h"
+#include "utils/event_filter.h"
+#include "utils/event_queue.h"
+#include <atomic>
+#include <chrono>
 #include <libbpf.h>
 #include <memory>
 #include <pybind11/pybind11.h>
 #include <string>
+#include <thread>
+#include <vector>
 
 class StructParser;
 class BpfMap;
+class ColumnLayout;
+class EventRecorder;
 
 namespace py = pybind11;
 
-class PerfEventArray {
+class PerfEventArray : public EventSource {
 private:
   std::shared_ptr<BpfMap> map_;
+  // Released after pb_ is freed, i.e. once our CPU slots are cleared
+  PerfSlotClaim claim_;
   struct perf_buffer *pb_;
   py::function callback_;
   py::object lost_callback_;
@@ -21,6 +34,49 @@ private:
   std::shared_ptr<StructParser> parser_;
   std::string struct_name_;
 
+  // Batch mode: samples are gathered natively and handed over in one call
+  struct PendingSample {
+    int cpu;
+    size_t offset;
+    size_t size;
+  };
+  size_t max_batch_size_;
+  std::chrono::microseconds flush_latency_;
+  std::chrono::steady_clock::time_point batch_started_;
+  std::vector<uint8_t> batch_data_;
+  std::vector<PendingSample> batch_samples_;
+
+  // Columnar mode: batches are decoded into one array per struct field
+  std::shared_ptr<const ColumnLayout> columns_;
+
+  // Evaluated on the raw sample before anything else
+  std::shared_ptr<EventFilter> filter_;
+  std::shared_ptr<const EventFilter::Predicate> predicate_;
+
+  // Hand callbacks an EventView into ring memory instead of a copy
+  bool zero_copy_;
+
+  ConsumerStats stats_;
+
+  // Raw samples are appended here before any Python delivery
+  std::shared_ptr<EventRecorder> recorder_;
+  bool deliver_recorded_;
+
+  // Budgeted consumption: samples delivered so far and where to resume
+  uint64_t delivered_;
+  size_t next_buffer_;
+
+  // Worker mode: native threads drain the per-CPU buffers into queue_
+  bool worker_mode_;
+  std::shared_ptr<EventQueue> queue_;
+  std::vector<std::thread> workers_;
+  std::atomic<bool> workers_stop_;
+  std::atomic<uint64_t> worker_lost_;
+
+  py::object make_event(const void *data, size_t size);
+  void flush_batch();
+  void worker_loop(int epoll_fd, size_t worker_idx, size_t num_workers);
+
   // Static callback wrappers for C API
   static void sample_callback_wrapper(void *ctx, int cpu, void *data,
                                       unsigned int size);
@@ -32,7 +88,7 @@ public:
   PerfEventArray(std::shared_ptr<BpfMap> map, int page_cnt,
                  py::function callback, const std::string &struct_name,
                  py::object lost_callback = py::none());
-  ~PerfEventArray();
+  ~PerfEventArray() override;
 
   PerfEventArray(const PerfEventArray &) = delete;
   PerfEventArray &operator=(const PerfEventArray &) = delete;
@@ -40,6 +96,89 @@ public:
   int poll(int timeout_ms);
   int consume();
 
+  /**
+   * Epoll fd covering every per-CPU buffer. It becomes readable when any
+   * buffer has data, so an event loop can watch it and call consume().
+   */
+  [[nodiscard]] int epoll_fd() const override {
+    return perf_buffer__epoll_fd(pb_);
+  }
+
+  /**
+   * Drain per-CPU buffers round-robin until `budget` samples have been
+   * delivered. The budget is checked between buffers, and the next call
+   * resumes with the buffer after the last one drained.
+   */
+  int consume_budget(size_t budget) override;
+
+  /**
+   * Deliver samples in batches: the callback receives a list of
+   * (cpu, event) tuples instead of one call per sample. A batch is flushed
+   * when it reaches max_batch_size, when its oldest sample is older than
+   * flush_latency_ms (0 = no limit), and at the end of every poll/consume.
+   * A max_batch_size of 0 restores per-sample delivery.
+   */
+  void set_batching(size_t max_batch_size, int flush_latency_ms = 0);
+
+  /**
+   * Decode batches column by column: the callback receives one ColumnBatch
+   * per flush holding a typed array per struct field (plus the CPUs)
+   * instead of a list of events. Needs a BTF-described struct_name.
+   * Without set_batching, every poll/consume is delivered as one batch.
+   */
+  void set_columnar(bool enabled);
+
+  /**
+   * Drop samples natively, before the GIL, copy or decode. Applies to every
+   * delivery mode including reader threads. Pass None to remove it.
+   */
+  void set_filter(std::shared_ptr<EventFilter> filter);
+
+  /**
+   * Append every accepted sample to a native recorder. With deliver=False
+   * samples stop there and the callback is never called, which is how to
+   * capture at full rate. Pass None to detach.
+   */
+  void set_recorder(std::shared_ptr<EventRecorder> recorder,
+                    bool deliver = false);
+
+  /**
+   * Pass each sample to the callback as an EventView pointing straight into
+   * the perf ring instead of a bytes copy. The view is only valid until the
+   * callback returns. Applies to per-sample delivery only; batched and
+   * reader-thread modes already own a copy of the data.
+   */
+  void set_zero_copy(bool enabled);
+
+  /**
+   * Start native reader threads. Each thread owns a shard of the per-CPU
+   * buffers and drains it continuously into a bounded lock-free queue,
+   * independent of the GIL. Python pulls events with read_events();
+   * poll()/consume() are unavailable until stop_workers().
+   * Lost-sample notifications are counted instead of calling Python.
+   * Samples up to slot_size bytes are copied into preallocated queue
+   * slots; larger ones go through a per-slot buffer that is reused.
+   */
+  void start_workers(size_t num_threads, size_t queue_capacity,
+                     OverflowPolicy policy = OverflowPolicy::DropOldest,
+                     size_t slot_size = EventQueue::kDefaultSlotSize);
+  void stop_workers();
+
+  /**
+   * Pop up to max_events queued events as (cpu, event) tuples, waiting up
+   * to timeout_ms for the first one (-1 waits indefinitely).
+   */
+  py::list read_events(size_t max_events, int timeout_ms);
+  [[nodiscard]] py::dict get_queue_stats() const;
+
+  /**
+   * Counter snapshot: per-CPU samples/bytes/lost, polls and time spent in
+   * poll (including dispatch), decoding, callbacks and waiting for the GIL,
+   * plus a log2 histogram of callback durations.
+   */
+  [[nodiscard]] py::dict stats() const { return stats_.snapshot(); }
+  void reset_stats() { stats_.reset(); }
+
   [[nodiscard]] std::shared_ptr<BpfMap> get_map() const { return map_; }
 };
 
@@ -0,0 +1,205 @@
+#include "maps/perf_flight_recorder.h"
+#include "core/bpf_exception.h"
+#include "core/bpf_map.h"
+#include "core/bpf_object.h"
+#include "utils/struct_parser.h"
+#include <algorithm>
+#include <bpf.h>
+#include <cerrno>
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+
+// PERF_RECORD_SAMPLE body for PERF_SAMPLE_TIME | PERF_SAMPLE_RAW
+struct SampleHeader {
+  struct perf_event_header header;
+  uint64_t time;
+  uint32_t size;
+} __attribute__((packed));
+
+} // namespace
+
+PerfFlightRecorder::PerfFlightRecorder(std::shared_ptr<BpfMap> map,
+                                       int page_cnt,
+                                       const std::string &struct_name)
+    : map_(std::move(map)), claim_(*map_), struct_name_(struct_name),
+      page_size_(sysconf(_SC_PAGESIZE)), data_size_(0) {
+  if (map_->get_type() != BPF_MAP_TYPE_PERF_EVENT_ARRAY) {
+    throw BpfException("Map '" + map_->get_name() +
+                       "' is not a PERF_EVENT_ARRAY");
+  }
+
+  if (page_cnt <= 0 || (page_cnt & (page_cnt - 1)) != 0) {
+    throw BpfException("page_cnt must be a positive power of 2");
+  }
+  data_size_ = page_size_ * page_cnt;
+
+  if (!struct_name_.empty()) {
+    auto parent = map_->get_parent();
+    if (!parent) {
+      throw BpfException("Parent BpfObject has been destroyed");
+    }
+
+    parser_ = parent->get_struct_parser();
+    if (!parser_) {
+      throw BpfException("Unknown struct: " + struct_name_);
+    }
+    parser_->prepare(struct_name_);
+  }
+
+  const int cpus = std::min(libbpf_num_possible_cpus(),
+                            map_->get_max_entries());
+  try {
+    for (int cpu = 0; cpu < cpus; ++cpu) {
+      open_ring(cpu);
+    }
+  } catch (...) {
+    close_rings();
+    throw;
+  }
+
+  if (rings_.empty()) {
+    throw BpfException("No online CPUs to record on");
+  }
+}
+
+PerfFlightRecorder::~PerfFlightRecorder() { close_rings(); }
+
+void PerfFlightRecorder::open_ring(int cpu) {
+  struct perf_event_attr attr = {};
+  attr.size = sizeof(attr);
+  attr.type = PERF_TYPE_SOFTWARE;
+  attr.config = PERF_COUNT_SW_BPF_OUTPUT;
+  attr.sample_type = PERF_SAMPLE_TIME | PERF_SAMPLE_RAW;
+  attr.sample_period = 1;
+  attr.write_backward = 1;
+
+  int fd = static_cast<int>(syscall(__NR_perf_event_open, &attr, -1, cpu, -1,
+                                    PERF_FLAG_FD_CLOEXEC));
+  if (fd < 0) {
+    if (errno == ENODEV) {
+      return; // Possible but offline CPU
+    }
+    throw BpfException("Failed to open perf event on CPU " +
+                       std::to_string(cpu) + ": " + std::strerror(errno));
+  }
+
+  // A read-only mapping is what puts the ring in overwrite mode
+  void *base = ::mmap(nullptr, page_size_ + data_size_, PROT_READ, MAP_SHARED,
+                      fd, 0);
+  if (base == MAP_FAILED) {
+    int err = errno;
+    close(fd);
+    throw BpfException("Failed to map perf ring on CPU " +
+                       std::to_string(cpu) + ": " + std::strerror(err));
+  }
+
+  if (bpf_map_update_elem(map_->get_fd(), &cpu, &fd, BPF_ANY) < 0) {
+    int err = errno;
+    munmap(base, page_size_ + data_size_);
+    close(fd);
+    throw BpfException("Failed to install perf ring for CPU " +
+                       std::to_string(cpu) + ": " + std::strerror(err));
+  }
+
+  rings_.push_back({cpu, fd, base});
+}
+
+void PerfFlightRecorder::close_rings() {
+  // claim_ keeps other consumers in this process off the map, so the slots
+  // still hold our fds
+  for (const auto &ring : rings_) {
+    bpf_map_delete_elem(map_->get_fd(), &ring.cpu);
+    munmap(ring.base, page_size_ + data_size_);
+    close(ring.fd);
+  }
+  rings_.clear();
+}
+
+void PerfFlightRecorder::read_ring(const CpuRing &ring, size_t max_events,
+                                   std::vector<Record> &out) const {
+  const auto *meta = static_cast<const perf_event_mmap_page *>(ring.base);
+  const auto *data = static_cast<const uint8_t *>(ring.base) + page_size_;
+
+  // Backward rings count head down from zero; newest record sits at head
+  const uint64_t head = __atomic_load_n(&meta->data_head, __ATOMIC_ACQUIRE);
+  const uint64_t limit = std::min<uint64_t>(data_size_, -head);
+
+  std::vector<uint8_t> record;
+  size_t count = 0;
+  uint64_t pos = 0;
+  while (pos + sizeof(perf_event_header) <= limit &&
+         (max_events == 0 || count < max_events)) {
+    struct perf_event_header header;
+    for (size_t i = 0; i < sizeof(header); ++i) {
+      reinterpret_cast<uint8_t *>(&header)[i] =
+          data[(head + pos + i) % data_size_];
+    }
+    // A zero size means never-written space; a record past the limit has
+    // been partly overwritten by newer ones
+    if (header.size == 0 || pos + header.size > limit) {
+      break;
+    }
+
+    record.resize(header.size);
+    for (size_t i = 0; i < header.size; ++i) {
+      record[i] = data[(head + pos + i) % data_size_];
+    }
+    pos += header.size;
+
+    if (header.type != PERF_RECORD_SAMPLE ||
+        header.size < sizeof(SampleHeader)) {
+      continue;
+    }
+
+    SampleHeader sample;
+    std::memcpy(&sample, record.data(), sizeof(sample));
+    const size_t payload = std::min<size_t>(
+        sample.size, header.size - sizeof(SampleHeader));
+    const uint8_t *raw = record.data() + sizeof(SampleHeader);
+    out.push_back({ring.cpu, sample.time,
+                   std::vector<uint8_t>(raw, raw + payload)});
+    ++count;
+  }
+}
+
+py::list PerfFlightRecorder::snapshot(size_t max_events_per_cpu) {
+  std::vector<Record> records;
+  {
+    py::gil_scoped_release release;
+    for (const auto &ring : rings_) {
+      // Freeze the ring so the kernel cannot overwrite what we read; a
+      // live backward ring would hand back torn records
+      if (ioctl(ring.fd, PERF_EVENT_IOC_PAUSE_OUTPUT, 1) < 0) {
+        throw BpfException("Failed to pause perf ring on CPU " +
+                           std::to_string(ring.cpu) + ": " +
+                           std::strerror(errno));
+      }
+      read_ring(ring, max_events_per_cpu, records);
+      ioctl(ring.fd, PERF_EVENT_IOC_PAUSE_OUTPUT, 0);
+    }
+
+    std::stable_sort(
+        records.begin(), records.end(),
+        [](const Record &a, const Record &b) { return a.time < b.time; });
+  }
+
+  py::list events;
+  for (const auto &rec : records) {
+    py::object event;
+    if (parser_) {
+      event = parser_->parse_raw(struct_name_, rec.data.data(),
+                                 rec.data.size());
+    } else {
+      event = py::bytes(reinterpret_cast<const char *>(rec.data.data()),
+                        rec.data.size());
+    }
+    events.append(py::make_tuple(rec.cpu, rec.time, event));
+  }
+  return events;
+}
@@ -0,0 +1,73 @@
+#ifndef PYLIBBPF_PERF_FLIGHT_RECORDER_H
+#define PYLIBBPF_PERF_FLIGHT_RECORDER_H
+
+#include "maps/perf_slot_claim.h"
+#include <cstdint>
+#include <memory>
+#include <pybind11/pybind11.h>
+#include <string>
+#include <vector>
+
+class StructParser;
+class BpfMap;
+
+namespace py = pybind11;
+
+/**
+ * PerfFlightRecorder - Overwritable per-CPU perf rings for a
+ * PERF_EVENT_ARRAY.
+ *
+ * The kernel writes backward into read-only mapped rings and overwrites
+ * the oldest samples when full, so recording costs nothing in userspace.
+ * snapshot() pauses each ring, copies out the newest samples and resumes;
+ * it raises rather than read a ring that could not be paused. The rings
+ * take over every CPU slot of the map, so it cannot be shared with a
+ * PerfEventArray (see PerfSlotClaim).
+ */
+class PerfFlightRecorder {
+private:
+  struct CpuRing {
+    int cpu;
+    int fd;
+    void *base;
+  };
+
+  struct Record {
+    int cpu;
+    uint64_t time;
+    std::vector<uint8_t> data;
+  };
+
+  std::shared_ptr<BpfMap> map_;
+  PerfSlotClaim claim_;
+  std::shared_ptr<StructParser> parser_;
+  std::string struct_name_;
+  size_t page_size_;
+  size_t data_size_;
+  std::vector<CpuRing> rings_;
+
+  void open_ring(int cpu);
+  void close_rings();
+  // Walk one paused ring from newest to oldest
+  void read_ring(const CpuRing &ring, size_t max_events,
+                 std::vector<Record> &out) const;
+
+public:
+  PerfFlightRecorder(std::shared_ptr<BpfMap> map, int page_cnt,
+                     const std::string &struct_name = "");
+  ~PerfFlightRecorder();
+
+  PerfFlightRecorder(const PerfFlightRecorder &) = delete;
+  PerfFlightRecorder &operator=(const PerfFlightRecorder &) = delete;
+
+  /**
+   * Newest max_events_per_cpu samples from every CPU (0 = all still in
+   * the rings), as (cpu, timestamp_ns, event) tuples oldest first.
+   */
+  py::list snapshot(size_t max_events_per_cpu = 0);
+
+  [[nodiscard]] size_t get_num_rings() const { return rings_.size(); }
+  [[nodiscard]] std::shared_ptr<BpfMap> get_map() const { return map_; }
+};
+
+#endif // PYLIBBPF_PERF_FLIGHT_RECORDER_H
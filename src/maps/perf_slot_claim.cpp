@@ -0,0 +1,39 @@
+#include "maps/perf_slot_claim.h"
+#include "core/bpf_exception.h"
+#include "core/bpf_map.h"
+#include <bpf.h>
+#include <cerrno>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+
+namespace {
+
+// Keyed by kernel map id, so maps shared through reuse_map() or a pin
+// count as one
+std::mutex claims_mutex;
+std::unordered_set<__u32> claimed_maps;
+
+} // namespace
+
+PerfSlotClaim::PerfSlotClaim(const BpfMap &map) : map_id_(0) {
+  struct bpf_map_info info = {};
+  __u32 len = sizeof(info);
+  if (bpf_obj_get_info_by_fd(map.get_fd(), &info, &len) < 0) {
+    throw BpfException("Failed to get info of map '" + map.get_name() +
+                       "': " + std::strerror(errno));
+  }
+
+  std::lock_guard<std::mutex> lock(claims_mutex);
+  if (!claimed_maps.insert(info.id).second) {
+    throw BpfException("Map '" + map.get_name() +
+                       "' already feeds a perf consumer; close it first");
+  }
+  map_id_ = info.id;
+}
+
+PerfSlotClaim::~PerfSlotClaim() {
+  std::lock_guard<std::mutex> lock(claims_mutex);
+  claimed_maps.erase(map_id_);
+}
@@ -0,0 +1,30 @@
+#ifndef PYLIBBPF_PERF_SLOT_CLAIM_H
+#define PYLIBBPF_PERF_SLOT_CLAIM_H
+
+#include <linux/types.h>
+
+class BpfMap;
+
+/**
+ * PerfSlotClaim - Exclusive use of a PERF_EVENT_ARRAY's CPU slots.
+ *
+ * PerfEventArray and PerfFlightRecorder install their own perf event fd in
+ * every CPU slot and clear the slots again when they go away, so two of
+ * them on one map would silently take over each other's events. A consumer
+ * holds the claim for its lifetime and a second one in this process is
+ * rejected. The kernel cannot compare-and-swap these slots or even read
+ * them back, so a consumer in another process is not detected.
+ */
+class PerfSlotClaim {
+private:
+  __u32 map_id_;
+
+public:
+  explicit PerfSlotClaim(const BpfMap &map);
+  ~PerfSlotClaim();
+
+  PerfSlotClaim(const PerfSlotClaim &) = delete;
+  PerfSlotClaim &operator=(const PerfSlotClaim &) = delete;
+};
+
+#endif // PYLIBBPF_PERF_SLOT_CLAIM_H
@@ -0,0 +1,112 @@
+#include "maps/poller.h"
+#include "core/bpf_exception.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+Poller::Poller() : epoll_fd_(epoll_create1(EPOLL_CLOEXEC)), rotation_(0) {
+  if (epoll_fd_ < 0) {
+    throw BpfException("Failed to create epoll instance: " +
+                       std::string(std::strerror(errno)));
+  }
+}
+
+Poller::~Poller() {
+  if (epoll_fd_ >= 0) {
+    close(epoll_fd_);
+  }
+}
+
+std::vector<Poller::Entry>::iterator Poller::find(const EventSource *source) {
+  return std::find_if(entries_.begin(), entries_.end(), [&](const Entry &e) {
+    return e.source.get() == source;
+  });
+}
+
+void Poller::add(std::shared_ptr<EventSource> source, int priority,
+                 size_t budget) {
+  if (!source) {
+    throw BpfException("Event source is null");
+  }
+  if (find(source.get()) != entries_.end()) {
+    throw BpfException("Event source is already registered");
+  }
+
+  struct epoll_event ev = {};
+  ev.events = EPOLLIN;
+  ev.data.ptr = source.get();
+  if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, source->epoll_fd(), &ev) < 0) {
+    throw BpfException("Failed to register event source: " +
+                       std::string(std::strerror(errno)));
+  }
+
+  entries_.push_back({std::move(source), priority, budget});
+}
+
+void Poller::remove(const std::shared_ptr<EventSource> &source) {
+  auto it = find(source.get());
+  if (it == entries_.end()) {
+    throw BpfException("Event source is not registered");
+  }
+
+  epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, source->epoll_fd(), nullptr);
+  entries_.erase(it);
+}
+
+int Poller::poll(int timeout_ms) {
+  if (entries_.empty()) {
+    throw BpfException("No event sources registered");
+  }
+
+  // add()/remove() may run on other threads once the GIL is released, so
+  // dispatch from a snapshot taken while we still hold it. The shared_ptrs
+  // also keep a source removed mid-wait alive until this round is done.
+  const std::vector<Entry> entries = entries_;
+  const size_t rotation = rotation_++;
+
+  std::vector<struct epoll_event> events(entries.size());
+  std::vector<Entry> ready;
+  int delivered = 0;
+
+  // Release GIL once for the wait and the whole dispatch round
+  py::gil_scoped_release release;
+
+  int cnt = epoll_wait(epoll_fd_, events.data(),
+                       static_cast<int>(events.size()), timeout_ms);
+  if (cnt < 0) {
+    return errno == EINTR ? 0 : -errno;
+  }
+
+  for (int i = 0; i < cnt; ++i) {
+    auto *source = static_cast<EventSource *>(events[i].data.ptr);
+    auto it =
+        std::find_if(entries.begin(), entries.end(), [&](const Entry &e) {
+          return e.source.get() == source;
+        });
+    if (it != entries.end()) {
+      ready.push_back(*it);
+    }
+  }
+
+  // Rotate before the stable sort so equal priorities take turns first
+  if (!ready.empty()) {
+    std::rotate(ready.begin(), ready.begin() + rotation % ready.size(),
+                ready.end());
+  }
+  std::stable_sort(ready.begin(), ready.end(),
+                   [](const Entry &a, const Entry &b) {
+                     return a.priority > b.priority;
+                   });
+
+  for (const auto &entry : ready) {
+    int ret = entry.source->consume_budget(entry.budget);
+    if (ret < 0) {
+      return ret;
+    }
+    delivered += ret;
+  }
+  return delivered;
+}
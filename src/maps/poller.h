@@ -0,0 +1,55 @@
+#ifndef PYLIBBPF_POLLER_H
+#define PYLIBBPF_POLLER_H
+
+#include "maps/event_source.h"
+#include <memory>
+#include <pybind11/pybind11.h>
+#include <vector>
+
+namespace py = pybind11;
+
+/**
+ * Poller - Waits on many event sources with a single epoll set.
+ *
+ * Sources from any number of BpfObjects are nested into one epoll fd, so a
+ * single poll() releases the GIL once and dispatches whichever are ready.
+ * Ready sources are served by descending priority (round-robin among
+ * equals), each limited to its budget per poll; leftovers stay readable and
+ * are picked up by the next poll().
+ */
+class Poller {
+private:
+  struct Entry {
+    std::shared_ptr<EventSource> source;
+    int priority;
+    size_t budget; // 0 = unlimited
+  };
+
+  int epoll_fd_;
+  std::vector<Entry> entries_;
+  size_t rotation_;
+
+  std::vector<Entry>::iterator find(const EventSource *source);
+
+public:
+  Poller();
+  ~Poller();
+
+  Poller(const Poller &) = delete;
+  Poller &operator=(const Poller &) = delete;
+
+  void add(std::shared_ptr<EventSource> source, int priority = 0,
+           size_t budget = 0);
+  void remove(const std::shared_ptr<EventSource> &source);
+
+  /**
+   * Wait up to timeout_ms for any source, then dispatch the ready ones.
+   * Returns the number of events delivered.
+   */
+  int poll(int timeout_ms);
+
+  [[nodiscard]] int epoll_fd() const { return epoll_fd_; }
+  [[nodiscard]] size_t size() const { return entries_.size(); }
+};
+
+#endif // PYLIBBPF_POLLER_H
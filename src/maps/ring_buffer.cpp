@@ -0,0 +1,167 @@
+#include "maps/ring_buffer.h"
+#include "core/bpf_exception.h"
+#include "core/bpf_map.h"
+#include "core/bpf_object.h"
+#include "utils/event_view.h"
+#include "utils/struct_parser.h"
+#include <cerrno>
+#include <cstring>
+
+RingBuffer::RingBuffer(std::shared_ptr<BpfMap> map, py::function callback,
+                       const std::string &struct_name)
+    : rb_(nullptr), zero_copy_(false) {
+  auto ctx = make_context(map, std::move(callback), struct_name);
+
+  struct ring_buffer_opts rb_opts = {};
+  rb_opts.sz = sizeof(rb_opts); // Required for forward compatibility
+
+  rb_ = ring_buffer__new(map->get_fd(), sample_callback_wrapper, ctx.get(),
+                         &rb_opts);
+  if (!rb_) {
+    throw BpfException("Failed to create ring buffer: " +
+                       std::string(std::strerror(errno)));
+  }
+
+  rings_.push_back(std::move(ctx));
+}
+
+RingBuffer::~RingBuffer() {
+  if (rb_) {
+    ring_buffer__free(rb_);
+  }
+}
+
+std::unique_ptr<RingBuffer::RingContext>
+RingBuffer::make_context(const std::shared_ptr<BpfMap> &map,
+                         py::function callback,
+                         const std::string &struct_name) {
+  if (!map) {
+    throw BpfException("Ring buffer map is null");
+  }
+
+  if (map->get_type() != BPF_MAP_TYPE_RINGBUF) {
+    throw BpfException("Map '" + map->get_name() + "' is not a RINGBUF");
+  }
+
+  auto ctx = std::make_unique<RingContext>();
+  ctx->owner = this;
+  ctx->map = map;
+  ctx->callback = std::move(callback);
+
+  if (!struct_name.empty()) {
+    auto parent = map->get_parent();
+    if (!parent) {
+      throw BpfException("Parent BpfObject has been destroyed");
+    }
+
+    ctx->parser = parent->get_struct_parser();
+    ctx->struct_name = struct_name;
+
+    if (!ctx->parser) {
+      throw BpfException("Unknown struct: " + struct_name);
+    }
+    // Compile the decode plan now rather than on the first record
+    ctx->parser->prepare(struct_name);
+  }
+
+  return ctx;
+}
+
+void RingBuffer::add(std::shared_ptr<BpfMap> map, py::function callback,
+                     const std::string &struct_name) {
+  auto ctx = make_context(map, std::move(callback), struct_name);
+
+  const int ret =
+      ring_buffer__add(rb_, map->get_fd(), sample_callback_wrapper, ctx.get());
+  if (ret < 0) {
+    throw BpfException("Failed to add map '" + map->get_name() +
+                       "' to ring buffer: " + std::strerror(-ret));
+  }
+
+  rings_.push_back(std::move(ctx));
+}
+
+int RingBuffer::sample_callback_wrapper(void *ctx, void *data, size_t size) {
+  auto *ring = static_cast<RingContext *>(ctx);
+
+  if (ring->filter && !ring->filter->admit(*ring->predicate, data, size)) {
+    return 0;
+  }
+
+  // Acquire GIL for Python calls
+  py::gil_scoped_acquire acquire;
+
+  std::shared_ptr<EventView> view;
+  try {
+    if (ring->owner->zero_copy_) {
+      view = std::make_shared<EventView>(data, size, ring->parser,
+                                         ring->struct_name);
+      ring->callback(view);
+    } else if (ring->parser) {
+      ring->callback(ring->parser->parse_raw(ring->struct_name, data, size));
+    } else {
+      ring->callback(py::bytes(static_cast<const char *>(data), size));
+    }
+  } catch (const py::error_already_set &e) {
+    PyErr_Print();
+  } catch (const std::exception &e) {
+    py::print("C++ error in ring buffer callback:", e.what());
+  }
+
+  // The record is released back to the producer once we return
+  if (view) {
+    view->release();
+  }
+
+  // Keep consuming; a negative value would abort the whole poll
+  return 0;
+}
+
+void RingBuffer::set_filter(std::shared_ptr<EventFilter> filter,
+                            std::shared_ptr<BpfMap> map) {
+  // Bind everything first so a bad field leaves no ring half-updated
+  std::vector<std::shared_ptr<const EventFilter::Predicate>> predicates;
+  bool matched = false;
+  for (const auto &ring : rings_) {
+    bool selected = !map || ring->map == map;
+    matched |= selected;
+    predicates.push_back(selected && filter ? filter->bind(ring->parser.get(),
+                                                           ring->struct_name)
+                                            : nullptr);
+  }
+  if (!matched) {
+    throw BpfException("Map '" + map->get_name() +
+                       "' is not registered on this ring buffer");
+  }
+
+  for (size_t i = 0; i < rings_.size(); ++i) {
+    if (!map || rings_[i]->map == map) {
+      rings_[i]->filter = filter;
+      rings_[i]->predicate = predicates[i];
+    }
+  }
+}
+
+int RingBuffer::poll(int timeout_ms) {
+  // Release GIL during blocking poll
+  py::gil_scoped_release release;
+  return ring_buffer__poll(rb_, timeout_ms);
+}
+
+int RingBuffer::consume() {
+  py::gil_scoped_release release;
+  return ring_buffer__consume(rb_);
+}
+
+int RingBuffer::consume_budget(size_t budget) {
+  return budget ? ring_buffer__consume_n(rb_, budget)
+                : ring_buffer__consume(rb_);
+}
+
+py::list RingBuffer::get_maps() const {
+  py::list maps;
+  for (const auto &ring : rings_) {
+    maps.append(ring->map);
+  }
+  return maps;
+}
@@ -0,0 +1,87 @@
+#ifndef PYLIBBPF_RING_BUFFER_H
+#define PYLIBBPF_RING_BUFFER_H
+
+#include "maps/event_source.h"
+#include "utils/event_filter.h"
+#include <libbpf.h>
+#include <memory>
+#include <pybind11/pybind11.h>
+#include <string>
+#include <vector>
+
+class StructParser;
+class BpfMap;
+
+namespace py = pybind11;
+
+/**
+ * RingBuffer - Consumer for BPF_MAP_TYPE_RINGBUF maps.
+ *
+ * Several ring buffer maps, from any number of objects, can be registered
+ * on a single instance with add(); one poll() then services all of them.
+ */
+class RingBuffer : public EventSource {
+private:
+  // Per-ring state handed to libbpf as the callback context
+  struct RingContext {
+    RingBuffer *owner;
+    std::shared_ptr<BpfMap> map;
+    py::function callback;
+    std::shared_ptr<StructParser> parser;
+    std::string struct_name;
+    std::shared_ptr<EventFilter> filter;
+    std::shared_ptr<const EventFilter::Predicate> predicate;
+  };
+
+  struct ring_buffer *rb_;
+  std::vector<std::unique_ptr<RingContext>> rings_;
+  bool zero_copy_;
+
+  std::unique_ptr<RingContext>
+  make_context(const std::shared_ptr<BpfMap> &map, py::function callback,
+               const std::string &struct_name);
+
+  // Static callback wrapper for C API
+  static int sample_callback_wrapper(void *ctx, void *data, size_t size);
+
+public:
+  RingBuffer(std::shared_ptr<BpfMap> map, py::function callback,
+             const std::string &struct_name = "");
+  ~RingBuffer() override;
+
+  RingBuffer(const RingBuffer &) = delete;
+  RingBuffer &operator=(const RingBuffer &) = delete;
+
+  /**
+   * Register another ring buffer map on this consumer.
+   */
+  void add(std::shared_ptr<BpfMap> map, py::function callback,
+           const std::string &struct_name = "");
+
+  int poll(int timeout_ms);
+  int consume();
+
+  // Readable when any registered ring has records; pair with consume()
+  [[nodiscard]] int epoll_fd() const override {
+    return ring_buffer__epoll_fd(rb_);
+  }
+  int consume_budget(size_t budget) override;
+
+  /**
+   * Pass records to callbacks as an EventView into the ring instead of a
+   * bytes copy. The view is only valid until the callback returns.
+   */
+  void set_zero_copy(bool enabled) { zero_copy_ = enabled; }
+
+  /**
+   * Drop records natively before the GIL is taken. Conditions resolve
+   * against each ring's own struct; map=None applies the filter to every
+   * registered ring, and filter=None removes it.
+   */
+  void set_filter(std::shared_ptr<EventFilter> filter,
+                  std::shared_ptr<BpfMap> map = nullptr);
+
+  [[nodiscard]] py::list get_maps() const;
+};
+
+#endif // PYLIBBPF_RING_BUFFER_H
@@ -0,0 +1,488 @@
+#include "utils/btf_codec.h"
+#include "core/bpf_exception.h"
+#include <cstring>
+#include <string_view>
+
+namespace {
+
+// Guards against malformed or self-referencing BTF
+constexpr int kMaxDepth = 32;
+
+std::string type_name(const struct btf *btf, const struct btf_type *t) {
+  const char *name = btf__name_by_offset(btf, t->name_off);
+  return name ? name : "";
+}
+
+// View of a bytes or bytearray object; false for anything else
+bool bytes_view(py::handle obj, std::string_view &view) {
+  if (PyBytes_Check(obj.ptr())) {
+    view = {PyBytes_AS_STRING(obj.ptr()),
+            static_cast<size_t>(PyBytes_GET_SIZE(obj.ptr()))};
+    return true;
+  }
+  if (PyByteArray_Check(obj.ptr())) {
+    view = {PyByteArray_AS_STRING(obj.ptr()),
+            static_cast<size_t>(PyByteArray_GET_SIZE(obj.ptr()))};
+    return true;
+  }
+  return false;
+}
+
+std::string size_error(const std::string &name, size_t got, size_t max) {
+  return "Got " + std::to_string(got) + " bytes for '" + name +
+         "', which holds at most " + std::to_string(max);
+}
+
+uint64_t load_uint(const uint8_t *data, size_t size) {
+  uint64_t value = 0;
+  std::memcpy(&value, data, size); // BPF targets are little-endian here
+  return value;
+}
+
+int64_t sign_extend(uint64_t value, uint32_t bits) {
+  if (bits >= 64) {
+    return static_cast<int64_t>(value);
+  }
+  uint64_t sign = uint64_t{1} << (bits - 1);
+  return static_cast<int64_t>((value ^ sign) - sign);
+}
+
+} // namespace
+
+BtfCodec::BtfCodec(const struct btf *btf, __u32 type_id) {
+  if (!btf) {
+    throw BpfException("BPF object has no BTF information");
+  }
+  plan_ = compile(btf, type_id, 0);
+}
+
+std::shared_ptr<BtfCodec> BtfCodec::for_name(const struct btf *btf,
+                                             const std::string &name) {
+  if (!btf) {
+    return nullptr;
+  }
+
+  for (__u32 kind : {BTF_KIND_STRUCT, BTF_KIND_UNION, BTF_KIND_TYPEDEF}) {
+    __s32 id = btf__find_by_name_kind(btf, name.c_str(), kind);
+    if (id > 0) {
+      return std::make_shared<BtfCodec>(btf, static_cast<__u32>(id));
+    }
+  }
+  return nullptr;
+}
+
+__u32 BtfCodec::resolve_id(const struct btf *btf, __u32 type_id) {
+  for (int depth = 0; depth < kMaxDepth; ++depth) {
+    const struct btf_type *t = btf__type_by_id(btf, type_id);
+    if (!t) {
+      break;
+    }
+    switch (btf_kind(t)) {
+    case BTF_KIND_TYPEDEF:
+    case BTF_KIND_VOLATILE:
+    case BTF_KIND_CONST:
+    case BTF_KIND_RESTRICT:
+    case BTF_KIND_TYPE_TAG:
+      type_id = t->type;
+      break;
+    default:
+      return type_id;
+    }
+  }
+  return type_id;
+}
+
+std::shared_ptr<const BtfTypePlan>
+BtfCodec::compile(const struct btf *btf, __u32 type_id, int depth) {
+  if (depth > kMaxDepth) {
+    throw BpfException("BTF type nesting too deep");
+  }
+
+  type_id = resolve_id(btf, type_id);
+  const struct btf_type *t = btf__type_by_id(btf, type_id);
+  if (!t) {
+    throw BpfException("Invalid BTF type id " + std::to_string(type_id));
+  }
+
+  auto plan = std::make_shared<BtfTypePlan>();
+  plan->name = type_name(btf, t);
+
+  switch (btf_kind(t)) {
+  case BTF_KIND_INT: {
+    __u8 encoding = btf_int_encoding(t);
+    plan->size = t->size;
+    plan->is_signed = encoding & BTF_INT_SIGNED;
+    plan->is_char = (encoding & BTF_INT_CHAR) || plan->name == "char";
+    if (encoding & BTF_INT_BOOL) {
+      plan->kind = BtfTypePlan::Kind::Bool;
+    } else if (t->size <= 8) {
+      plan->kind = BtfTypePlan::Kind::Int;
+    }
+    break;
+  }
+  case BTF_KIND_ENUM:
+  case BTF_KIND_ENUM64:
+    plan->kind = BtfTypePlan::Kind::Int;
+    plan->size = t->size;
+    plan->is_signed = btf_kflag(t);
+    break;
+  case BTF_KIND_PTR:
+    plan->kind = BtfTypePlan::Kind::Int;
+    plan->size = sizeof(__u64);
+    break;
+  case BTF_KIND_FLOAT:
+    plan->size = t->size;
+    if (t->size == sizeof(float) || t->size == sizeof(double)) {
+      plan->kind = BtfTypePlan::Kind::Float;
+    }
+    break;
+  case BTF_KIND_ARRAY: {
+    const struct btf_array *arr = btf_array(t);
+    auto elem = compile(btf, arr->type, depth + 1);
+    plan->name = elem->name + "[" + std::to_string(arr->nelems) + "]";
+    plan->count = arr->nelems;
+    plan->size = elem->size * arr->nelems;
+    if (elem->size == 1 && elem->kind == BtfTypePlan::Kind::Int) {
+      plan->kind = elem->is_char ? BtfTypePlan::Kind::CharArray
+                                 : BtfTypePlan::Kind::Bytes;
+    } else {
+      plan->kind = BtfTypePlan::Kind::Array;
+    }
+    plan->elem = std::move(elem);
+    break;
+  }
+  case BTF_KIND_STRUCT:
+  case BTF_KIND_UNION: {
+    plan->kind = BtfTypePlan::Kind::Struct;
+    plan->size = t->size;
+    collect_members(btf, t, 0, plan->members, depth);
+
+    py::list field_names;
+    for (const auto &member : plan->members) {
+      field_names.append(member.name);
+    }
+    plan->tuple_type = py::module_::import("collections")
+                           .attr("namedtuple")(
+                               plan->name.empty() ? "anon" : plan->name,
+                               field_names, py::arg("rename") = true);
+    break;
+  }
+  default: {
+    // Anything else is exposed as raw bytes of its resolved size
+    __s64 size = btf__resolve_size(btf, type_id);
+    plan->size = size > 0 ? static_cast<size_t>(size) : 0;
+    break;
+  }
+  }
+
+  return plan;
+}
+
+void BtfCodec::collect_members(const struct btf *btf,
+                               const struct btf_type *type,
+                               uint32_t base_bit_offset,
+                               std::vector<BtfTypePlan::Member> &members,
+                               int depth) {
+  const struct btf_member *m = btf_members(type);
+  for (__u32 i = 0; i < btf_vlen(type); ++i, ++m) {
+    uint32_t bit_offset = base_bit_offset + btf_member_bit_offset(type, i);
+    std::string name = btf__name_by_offset(btf, m->name_off);
+
+    // Anonymous structs/unions contribute their members directly, as in C
+    const struct btf_type *member_type =
+        btf__type_by_id(btf, resolve_id(btf, m->type));
+    if (name.empty() && member_type && btf_is_composite(member_type)) {
+      collect_members(btf, member_type, bit_offset, members, depth + 1);
+      continue;
+    }
+
+    members.push_back({std::move(name), bit_offset,
+                       btf_member_bitfield_size(type, i),
+                       compile(btf, m->type, depth + 1)});
+  }
+}
+
+py::object BtfCodec::decode(const void *data, size_t size,
+                            StructFormat format, bool text) const {
+  if (size < plan_->size) {
+    throw BpfException("Got " + std::to_string(size) +
+                       " bytes, but type '" + plan_->name + "' needs " +
+                       std::to_string(plan_->size));
+  }
+  return decode_plan(*plan_, static_cast<const uint8_t *>(data), format,
+                     text);
+}
+
+py::object BtfCodec::decode_plan(const BtfTypePlan &plan,
+                                 const uint8_t *data, StructFormat format,
+                                 bool text) {
+  switch (plan.kind) {
+  case BtfTypePlan::Kind::Int: {
+    uint64_t raw = load_uint(data, plan.size);
+    if (plan.is_signed) {
+      return py::int_(sign_extend(raw, plan.size * 8));
+    }
+    return py::int_(raw);
+  }
+  case BtfTypePlan::Kind::Bool:
+    return py::bool_(load_uint(data, plan.size) != 0);
+  case BtfTypePlan::Kind::Float:
+    if (plan.size == sizeof(float)) {
+      float value;
+      std::memcpy(&value, data, sizeof(value));
+      return py::float_(value);
+    } else {
+      double value;
+      std::memcpy(&value, data, sizeof(value));
+      return py::float_(value);
+    }
+  case BtfTypePlan::Kind::CharArray: {
+    const char *str = reinterpret_cast<const char *>(data);
+    const size_t len = strnlen(str, plan.count);
+    if (!text) {
+      return py::bytes(str, len);
+    }
+    PyObject *decoded = PyUnicode_DecodeUTF8(
+        str, static_cast<Py_ssize_t>(len), "surrogateescape");
+    if (!decoded) {
+      throw py::error_already_set();
+    }
+    return py::reinterpret_steal<py::str>(decoded);
+  }
+  case BtfTypePlan::Kind::Bytes:
+    return py::bytes(reinterpret_cast<const char *>(data), plan.size);
+  case BtfTypePlan::Kind::Array: {
+    py::tuple items(plan.count);
+    for (size_t i = 0; i < plan.count; ++i) {
+      items[i] =
+          decode_plan(*plan.elem, data + i * plan.elem->size, format, text);
+    }
+    return items;
+  }
+  case BtfTypePlan::Kind::Struct:
+    break;
+  }
+
+  py::tuple values(plan.members.size());
+  for (size_t i = 0; i < plan.members.size(); ++i) {
+    const auto &member = plan.members[i];
+    if (member.bitfield_size) {
+      values[i] = decode_bitfield(*member.type, data, member.bit_offset,
+                                  member.bitfield_size);
+    } else {
+      values[i] = decode_plan(*member.type, data + member.bit_offset / 8,
+                              format, text);
+    }
+  }
+
+  switch (format) {
+  case StructFormat::Tuple:
+    return values;
+  case StructFormat::Dict: {
+    py::dict result;
+    for (size_t i = 0; i < plan.members.size(); ++i) {
+      result[py::str(plan.members[i].name)] = values[i];
+    }
+    return result;
+  }
+  case StructFormat::NamedTuple:
+    break;
+  }
+  return plan.tuple_type.attr("_make")(values);
+}
+
+py::object BtfCodec::decode_bitfield(const BtfTypePlan &plan,
+                                     const uint8_t *data, uint32_t bit_offset,
+                                     uint32_t bits) {
+  uint64_t value = extract_bitfield(data, bit_offset, bits, plan.is_signed);
+  if (plan.kind == BtfTypePlan::Kind::Bool) {
+    return py::bool_(value != 0);
+  }
+  if (plan.is_signed) {
+    return py::int_(static_cast<int64_t>(value));
+  }
+  return py::int_(value);
+}
+
+uint64_t BtfCodec::extract_bitfield(const uint8_t *data, uint32_t bit_offset,
+                                    uint32_t bits, bool is_signed) {
+  // A 64-bit field at an odd bit offset straddles nine bytes
+  uint32_t shift = bit_offset % 8;
+  size_t nbytes = (shift + bits + 7) / 8;
+  unsigned __int128 raw = 0;
+  std::memcpy(&raw, data + bit_offset / 8, nbytes);
+
+  raw >>= shift;
+  uint64_t value = static_cast<uint64_t>(raw);
+  if (bits < 64) {
+    value &= (uint64_t{1} << bits) - 1;
+  }
+  if (is_signed) {
+    return static_cast<uint64_t>(sign_extend(value, bits));
+  }
+  return value;
+}
+
+void BtfCodec::insert_bitfield(uint8_t *data, uint32_t bit_offset,
+                               uint32_t bits, uint64_t value) {
+  uint32_t shift = bit_offset % 8;
+  size_t nbytes = (shift + bits + 7) / 8;
+  unsigned __int128 raw = 0;
+  std::memcpy(&raw, data + bit_offset / 8, nbytes);
+
+  unsigned __int128 mask =
+      bits < 64 ? (uint64_t{1} << bits) - 1 : ~uint64_t{0};
+  raw &= ~(mask << shift);
+  raw |= (static_cast<unsigned __int128>(value) & mask) << shift;
+  std::memcpy(data + bit_offset / 8, &raw, nbytes);
+}
+
+void BtfCodec::encode(py::handle obj, void *out, size_t size) const {
+  if (size < plan_->size) {
+    throw BpfException("Buffer of " + std::to_string(size) +
+                       " bytes is too small for '" + plan_->name + "'");
+  }
+  std::memset(out, 0, size);
+  encode_plan(*plan_, obj, static_cast<uint8_t *>(out));
+}
+
+uint64_t BtfCodec::int_bits(const BtfTypePlan &plan, py::handle obj,
+                            uint32_t bits) {
+  if (plan.kind == BtfTypePlan::Kind::Bool) {
+    return PyObject_IsTrue(obj.ptr()) ? 1 : 0;
+  }
+  if (!py::isinstance<py::int_>(obj)) {
+    throw BpfException("Expected an int for '" + plan.name + "'");
+  }
+
+  // Check with the C API: pybind11 casts raise a bare cast_error for
+  // negative unsigned values and anything beyond 64 bits
+  if (plan.is_signed) {
+    int overflow = 0;
+    const int64_t value = PyLong_AsLongLongAndOverflow(obj.ptr(), &overflow);
+    if (overflow ||
+        (bits < 64 && (value < -(int64_t{1} << (bits - 1)) ||
+                       value >= (int64_t{1} << (bits - 1))))) {
+      throw BpfException("Value out of range for '" + plan.name + "'");
+    }
+    return static_cast<uint64_t>(value);
+  }
+
+  const uint64_t value = PyLong_AsUnsignedLongLong(obj.ptr());
+  if (PyErr_Occurred()) {
+    PyErr_Clear(); // Negative or wider than 64 bits
+    throw BpfException("Value out of range for '" + plan.name + "'");
+  }
+  if (bits < 64 && (value >> bits) != 0) {
+    throw BpfException("Value out of range for '" + plan.name + "'");
+  }
+  return value;
+}
+
+void BtfCodec::encode_plan(const BtfTypePlan &plan, py::handle obj,
+                           uint8_t *out) {
+  std::string_view raw;
+  const bool is_bytes = bytes_view(obj, raw);
+
+  switch (plan.kind) {
+  case BtfTypePlan::Kind::Int:
+  case BtfTypePlan::Kind::Bool:
+    if (!is_bytes) {
+      uint64_t value = int_bits(plan, obj, plan.size * 8);
+      std::memcpy(out, &value, plan.size);
+      return;
+    }
+    break;
+  case BtfTypePlan::Kind::Float:
+    if (!is_bytes) {
+      double value = obj.cast<double>();
+      if (plan.size == sizeof(float)) {
+        float f = static_cast<float>(value);
+        std::memcpy(out, &f, sizeof(f));
+      } else {
+        std::memcpy(out, &value, sizeof(value));
+      }
+      return;
+    }
+    break;
+  case BtfTypePlan::Kind::CharArray:
+    if (py::isinstance<py::str>(obj)) {
+      PyObject *encoded =
+          PyUnicode_AsEncodedString(obj.ptr(), "utf-8", "surrogateescape");
+      if (!encoded) {
+        throw py::error_already_set();
+      }
+      auto bytes = py::reinterpret_steal<py::bytes>(encoded);
+      bytes_view(bytes, raw);
+      // Keep room for the terminator
+      if (raw.size() >= plan.size) {
+        throw BpfException(size_error(plan.name, raw.size(), plan.size - 1));
+      }
+      std::memcpy(out, raw.data(), raw.size());
+      return;
+    }
+    break;
+  case BtfTypePlan::Kind::Bytes:
+    break;
+  case BtfTypePlan::Kind::Array: {
+    if (is_bytes) {
+      break;
+    }
+    auto seq = py::reinterpret_borrow<py::sequence>(obj);
+    if (seq.size() > plan.count) {
+      throw BpfException("Too many elements for '" + plan.name + "'");
+    }
+    for (size_t i = 0; i < seq.size(); ++i) {
+      encode_plan(*plan.elem, seq[i], out + i * plan.elem->size);
+    }
+    return;
+  }
+  case BtfTypePlan::Kind::Struct:
+    if (is_bytes) {
+      break;
+    }
+    if (py::isinstance<py::dict>(obj)) {
+      auto dict = py::reinterpret_borrow<py::dict>(obj);
+      for (const auto &member : plan.members) {
+        if (dict.contains(member.name)) {
+          encode_member(member, dict[py::str(member.name)], out);
+        }
+      }
+    } else if (py::isinstance<py::tuple>(obj) ||
+               py::isinstance<py::list>(obj)) {
+      auto seq = py::reinterpret_borrow<py::sequence>(obj);
+      if (seq.size() > plan.members.size()) {
+        throw BpfException("Too many fields for '" + plan.name + "'");
+      }
+      for (size_t i = 0; i < seq.size(); ++i) {
+        encode_member(plan.members[i], seq[i], out);
+      }
+    } else {
+      for (const auto &member : plan.members) {
+        if (py::hasattr(obj, member.name.c_str())) {
+          encode_member(member, obj.attr(member.name.c_str()), out);
+        }
+      }
+    }
+    return;
+  }
+
+  // Raw bytes are accepted for every type and copied verbatim
+  if (!is_bytes) {
+    throw BpfException("Expected bytes for '" + plan.name + "'");
+  }
+  if (raw.size() > plan.size) {
+    throw BpfException(size_error(plan.name, raw.size(), plan.size));
+  }
+  std::memcpy(out, raw.data(), raw.size());
+}
+
+void BtfCodec::encode_member(const BtfTypePlan::Member &member,
+                             py::handle obj, uint8_t *out) {
+  if (member.bitfield_size) {
+    insert_bitfield(out, member.bit_offset, member.bitfield_size,
+                    int_bits(*member.type, obj, member.bitfield_size));
+  } else {
+    encode_plan(*member.type, obj, out + member.bit_offset / 8);
+  }
+}
@@ -0,0 +1,126 @@
+#ifndef PYLIBBPF_BTF_CODEC_H
+#define PYLIBBPF_BTF_CODEC_H
+
+#include <btf.h>
+#include <cstdint>
+#include <memory>
+#include <pybind11/pybind11.h>
+#include <string>
+#include <vector>
+
+namespace py = pybind11;
+
+// How decoded structs are handed to Python
+enum class StructFormat { NamedTuple, Dict, Tuple };
+
+/**
+ * Decode plan for one BTF type, compiled once and then applied to raw bytes
+ * without consulting BTF again.
+ */
+struct BtfTypePlan {
+  enum class Kind {
+    Int,       // signed/unsigned integers, enums and pointers
+    Bool,      // _Bool
+    Float,     // float/double
+    CharArray, // char[N], NUL-trimmed bytes
+    Bytes,     // raw bytes (u8 arrays, unsupported kinds)
+    Array,     // tuple of elements
+    Struct,    // structs and unions
+  };
+
+  struct Member {
+    std::string name;
+    uint32_t bit_offset;
+    uint32_t bitfield_size; // 0 unless the member is a bitfield
+    std::shared_ptr<const BtfTypePlan> type;
+  };
+
+  Kind kind = Kind::Bytes;
+  std::string name;
+  size_t size = 0;
+  bool is_signed = false;
+  bool is_char = false;
+
+  // Arrays
+  size_t count = 0;
+  std::shared_ptr<const BtfTypePlan> elem;
+
+  // Structs and unions
+  std::vector<Member> members;
+  py::object tuple_type; // collections.namedtuple class
+};
+
+/**
+ * BtfCodec - Native decoder driven by the object's BTF.
+ *
+ * Handles integers of any signedness, enums, bitfields, arrays, char
+ * strings and nested structs/unions, emitting namedtuples, dicts or tuples
+ * straight from the raw bytes.
+ */
+class BtfCodec {
+private:
+  std::shared_ptr<const BtfTypePlan> plan_;
+
+  static std::shared_ptr<const BtfTypePlan>
+  compile(const struct btf *btf, __u32 type_id, int depth);
+  static void collect_members(const struct btf *btf,
+                              const struct btf_type *type,
+                              uint32_t base_bit_offset,
+                              std::vector<BtfTypePlan::Member> &members,
+                              int depth);
+
+  static py::object decode_plan(const BtfTypePlan &plan, const uint8_t *data,
+                                StructFormat format, bool text);
+  static py::object decode_bitfield(const BtfTypePlan &plan,
+                                    const uint8_t *data, uint32_t bit_offset,
+                                    uint32_t bits);
+
+  static void encode_plan(const BtfTypePlan &plan, py::handle obj,
+                          uint8_t *out);
+  static void encode_member(const BtfTypePlan::Member &member,
+                            py::handle obj, uint8_t *out);
+  // Range-checked integer bits for an int/enum/bool of `bits` width
+  static uint64_t int_bits(const BtfTypePlan &plan, py::handle obj,
+                           uint32_t bits);
+
+public:
+  BtfCodec(const struct btf *btf, __u32 type_id);
+
+  /**
+   * Look up a struct, union or typedef by name.
+   * Returns nullptr if the BTF has no such type.
+   */
+  static std::shared_ptr<BtfCodec> for_name(const struct btf *btf,
+                                            const std::string &name);
+
+  // Skip typedefs and const/volatile/restrict/type tag modifiers
+  static __u32 resolve_id(const struct btf *btf, __u32 type_id);
+
+  // Raw value of a bitfield, sign-extended when `is_signed`
+  static uint64_t extract_bitfield(const uint8_t *data, uint32_t bit_offset,
+                                   uint32_t bits, bool is_signed);
+
+  // Store the low `bits` of `value` at a bit offset
+  static void insert_bitfield(uint8_t *data, uint32_t bit_offset,
+                              uint32_t bits, uint64_t value);
+
+  /**
+   * Decode `size` bytes. With text=true char arrays become str
+   * (surrogateescape, so they round-trip through encode) instead of bytes.
+   */
+  [[nodiscard]] py::object decode(const void *data, size_t size,
+                                  StructFormat format,
+                                  bool text = false) const;
+
+  /**
+   * Encode into `size` bytes, zero-filling anything not given. Structs take
+   * dicts, sequences or objects with matching attributes; bytes are copied
+   * verbatim for any type.
+   */
+  void encode(py::handle obj, void *out, size_t size) const;
+
+  [[nodiscard]] size_t size() const { return plan_->size; }
+  [[nodiscard]] const BtfTypePlan &plan() const { return *plan_; }
+};
+
+#endif // PYLIBBPF_BTF_CODEC_H
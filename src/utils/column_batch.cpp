@@ -0,0 +1,221 @@
+#include "utils/column_batch.h"
+#include "core/bpf_exception.h"
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace {
+
+std::string scalar_format(const BtfTypePlan &plan) {
+  switch (plan.kind) {
+  case BtfTypePlan::Kind::Bool:
+    return py::format_descriptor<bool>::format();
+  case BtfTypePlan::Kind::Float:
+    return plan.size == sizeof(float) ? py::format_descriptor<float>::format()
+                                      : py::format_descriptor<double>::format();
+  case BtfTypePlan::Kind::Int:
+    if (!plan.is_signed) {
+      return MapBuffer::uint_format(plan.size);
+    }
+    switch (plan.size) {
+    case 1:
+      return py::format_descriptor<int8_t>::format();
+    case 2:
+      return py::format_descriptor<int16_t>::format();
+    case 4:
+      return py::format_descriptor<int32_t>::format();
+    case 8:
+      return py::format_descriptor<int64_t>::format();
+    }
+    return "";
+  default:
+    return "";
+  }
+}
+
+bool is_scalar(const BtfTypePlan &plan) {
+  return plan.kind == BtfTypePlan::Kind::Int ||
+         plan.kind == BtfTypePlan::Kind::Bool ||
+         plan.kind == BtfTypePlan::Kind::Float;
+}
+
+} // namespace
+
+// ==================== ColumnLayout ====================
+
+ColumnLayout::ColumnLayout(const BtfCodec &codec)
+    : record_size_(codec.size()) {
+  const BtfTypePlan &plan = codec.plan();
+  if (plan.kind == BtfTypePlan::Kind::Struct) {
+    flatten(plan, "", 0);
+  } else {
+    add_column("value", plan, 0, 0);
+  }
+
+  if (columns_.empty()) {
+    throw BpfException("Type '" + plan.name + "' has no decodable fields");
+  }
+}
+
+void ColumnLayout::flatten(const BtfTypePlan &plan, const std::string &prefix,
+                           uint32_t bit_offset) {
+  for (const auto &member : plan.members) {
+    std::string name = prefix + member.name;
+    uint32_t offset = bit_offset + member.bit_offset;
+
+    if (member.type->kind == BtfTypePlan::Kind::Struct) {
+      flatten(*member.type, name + ".", offset);
+    } else {
+      add_column(name, *member.type, offset, member.bitfield_size);
+    }
+  }
+}
+
+void ColumnLayout::add_column(const std::string &name,
+                              const BtfTypePlan &plan, uint32_t bit_offset,
+                              uint32_t bitfield_size) {
+  Column col{name, bit_offset, bitfield_size, plan.is_signed, false,
+             plan.size, 0, scalar_format(plan)};
+
+  if (plan.kind == BtfTypePlan::Kind::Array && is_scalar(*plan.elem)) {
+    col.item_size = plan.elem->size;
+    col.count = plan.count;
+    col.format = scalar_format(*plan.elem);
+  } else if (col.format.empty()) {
+    // char[] and anything without a native dtype become fixed-width bytes
+    col.trim_nul = plan.kind == BtfTypePlan::Kind::CharArray;
+    col.format = std::to_string(plan.size) + "s";
+  }
+
+  if (col.row_size() == 0 || col.format.empty()) {
+    return; // Flexible array members carry no fixed-size data
+  }
+  columns_.push_back(std::move(col));
+}
+
+// ==================== ColumnBatch ====================
+
+ColumnBatch::ColumnBatch(std::shared_ptr<const ColumnLayout> layout,
+                         size_t capacity)
+    : layout_(std::move(layout)), data_(layout_->columns().size()), size_(0) {
+  const auto &columns = layout_->columns();
+  for (size_t i = 0; i < columns.size(); ++i) {
+    data_[i].reserve(capacity * columns[i].row_size());
+  }
+  cpus_.reserve(capacity);
+}
+
+void ColumnBatch::append(int cpu, const void *data, size_t size) {
+  const auto *record = static_cast<const uint8_t *>(data);
+
+  std::vector<uint8_t> padded;
+  if (size < layout_->record_size()) {
+    padded.assign(layout_->record_size(), 0);
+    std::memcpy(padded.data(), data, size);
+    record = padded.data();
+  }
+
+  const auto &columns = layout_->columns();
+  for (size_t i = 0; i < columns.size(); ++i) {
+    const auto &col = columns[i];
+    auto &out = data_[i];
+    const size_t pos = out.size();
+    out.resize(pos + col.row_size());
+
+    if (col.bitfield_size) {
+      uint64_t value = BtfCodec::extract_bitfield(record, col.bit_offset,
+                                                  col.bitfield_size,
+                                                  col.is_signed);
+      std::memcpy(out.data() + pos, &value, col.item_size);
+      continue;
+    }
+
+    const uint8_t *src = record + col.bit_offset / 8;
+    std::memcpy(out.data() + pos, src, col.row_size());
+
+    if (col.trim_nul) {
+      // Zero everything after the terminator so equal strings compare equal
+      auto *begin = out.data() + pos;
+      auto *end = begin + col.row_size();
+      std::fill(std::find(begin, end, 0), end, 0);
+    }
+  }
+
+  cpus_.push_back(cpu);
+  ++size_;
+}
+
+void ColumnBatch::finish() {
+  if (cpu_buffer_) {
+    return;
+  }
+
+  const auto &columns = layout_->columns();
+  const auto rows = static_cast<py::ssize_t>(size_);
+  for (size_t i = 0; i < columns.size(); ++i) {
+    const auto &col = columns[i];
+    const auto item = static_cast<py::ssize_t>(col.item_size);
+
+    if (col.count) {
+      const auto count = static_cast<py::ssize_t>(col.count);
+      buffers_.push_back(std::make_shared<MapBuffer>(
+          std::move(data_[i]), col.format, col.item_size,
+          std::vector<py::ssize_t>{rows, count},
+          std::vector<py::ssize_t>{item * count, item}));
+    } else {
+      buffers_.push_back(std::make_shared<MapBuffer>(
+          std::move(data_[i]), col.format, col.item_size,
+          std::vector<py::ssize_t>{rows}, std::vector<py::ssize_t>{item}));
+    }
+  }
+
+  std::vector<uint8_t> cpu_bytes(cpus_.size() * sizeof(int32_t));
+  std::memcpy(cpu_bytes.data(), cpus_.data(), cpu_bytes.size());
+  cpu_buffer_ = std::make_shared<MapBuffer>(
+      std::move(cpu_bytes), py::format_descriptor<int32_t>::format(),
+      sizeof(int32_t), std::vector<py::ssize_t>{rows},
+      std::vector<py::ssize_t>{sizeof(int32_t)});
+
+  data_.clear();
+  cpus_.clear();
+}
+
+py::list ColumnBatch::get_columns() const {
+  py::list names;
+  for (const auto &col : layout_->columns()) {
+    names.append(col.name);
+  }
+  return names;
+}
+
+bool ColumnBatch::has_column(const std::string &name) const {
+  const auto &columns = layout_->columns();
+  return std::any_of(columns.begin(), columns.end(),
+                     [&](const auto &col) { return col.name == name; });
+}
+
+std::shared_ptr<MapBuffer> ColumnBatch::column(const std::string &name) {
+  finish();
+  const auto &columns = layout_->columns();
+  for (size_t i = 0; i < columns.size(); ++i) {
+    if (columns[i].name == name) {
+      return buffers_[i];
+    }
+  }
+  throw py::key_error("No column '" + name + "'");
+}
+
+std::shared_ptr<MapBuffer> ColumnBatch::cpus() {
+  finish();
+  return cpu_buffer_;
+}
+
+py::dict ColumnBatch::to_dict() {
+  finish();
+  py::dict result;
+  const auto &columns = layout_->columns();
+  for (size_t i = 0; i < columns.size(); ++i) {
+    result[py::str(columns[i].name)] = buffers_[i];
+  }
+  return result;
+}
@@ -0,0 +1,90 @@
+#ifndef PYLIBBPF_COLUMN_BATCH_H
+#define PYLIBBPF_COLUMN_BATCH_H
+
+#include "utils/btf_codec.h"
+#include "utils/map_buffer.h"
+#include <cstdint>
+#include <memory>
+#include <pybind11/pybind11.h>
+#include <string>
+#include <vector>
+
+namespace py = pybind11;
+
+class ColumnBatch;
+
+/**
+ * ColumnLayout - Flattened field layout of a BTF struct.
+ *
+ * Nested structs become dotted column names ("task.pid"). Scalars map to
+ * typed columns, char[] to NUL-trimmed fixed-width strings, other byte
+ * arrays to fixed-width bytes and scalar arrays to 2-D columns.
+ */
+class ColumnLayout {
+public:
+  struct Column {
+    std::string name;
+    uint32_t bit_offset;
+    uint32_t bitfield_size;
+    bool is_signed;
+    bool trim_nul;
+    size_t item_size;
+    size_t count; // elements per row; 0 for a 1-D column
+    std::string format;
+
+    [[nodiscard]] size_t row_size() const {
+      return count ? item_size * count : item_size;
+    }
+  };
+
+private:
+  std::vector<Column> columns_;
+  size_t record_size_;
+
+  void flatten(const BtfTypePlan &plan, const std::string &prefix,
+               uint32_t bit_offset);
+  void add_column(const std::string &name, const BtfTypePlan &plan,
+                  uint32_t bit_offset, uint32_t bitfield_size);
+
+public:
+  explicit ColumnLayout(const BtfCodec &codec);
+
+  [[nodiscard]] const std::vector<Column> &columns() const { return columns_; }
+  [[nodiscard]] size_t record_size() const { return record_size_; }
+};
+
+/**
+ * ColumnBatch - A batch of same-typed events stored column by column.
+ *
+ * Filled without the GIL; each column is exported as a MapBuffer that
+ * NumPy, pandas or Arrow can wrap without copying.
+ */
+class ColumnBatch {
+private:
+  std::shared_ptr<const ColumnLayout> layout_;
+  std::vector<std::vector<uint8_t>> data_;
+  std::vector<int32_t> cpus_;
+  size_t size_;
+
+  // Built from data_ on first access
+  std::vector<std::shared_ptr<MapBuffer>> buffers_;
+  std::shared_ptr<MapBuffer> cpu_buffer_;
+
+  void finish();
+
+public:
+  ColumnBatch(std::shared_ptr<const ColumnLayout> layout, size_t capacity);
+
+  // Append one event; short samples are zero-padded
+  void append(int cpu, const void *data, size_t size);
+
+  [[nodiscard]] size_t size() const { return size_; }
+  [[nodiscard]] py::list get_columns() const;
+  [[nodiscard]] bool has_column(const std::string &name) const;
+
+  [[nodiscard]] std::shared_ptr<MapBuffer> column(const std::string &name);
+  [[nodiscard]] std::shared_ptr<MapBuffer> cpus();
+  [[nodiscard]] py::dict to_dict();
+};
+
+#endif // PYLIBBPF_COLUMN_BATCH_H
@@ -0,0 +1,78 @@
+#include "utils/consumer_stats.h"
+#include <algorithm>
+#include <bit>
+
+ConsumerStats::ConsumerStats(int num_cpus)
+    : num_cpus_(static_cast<size_t>(std::max(num_cpus, 1))),
+      cpus_(std::make_unique<CpuCounters[]>(num_cpus_)) {}
+
+void ConsumerStats::record_callback(uint64_t gil_wait_ns,
+                                    uint64_t callback_ns) {
+  callbacks_.fetch_add(1, std::memory_order_relaxed);
+  callback_ns_.fetch_add(callback_ns, std::memory_order_relaxed);
+  gil_wait_ns_.fetch_add(gil_wait_ns, std::memory_order_relaxed);
+
+  // Bucket i holds durations in [2^i, 2^(i+1)) ns; bucket 0 also holds 0
+  size_t bucket = callback_ns ? std::bit_width(callback_ns) - 1 : 0;
+  latency_[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+py::dict ConsumerStats::snapshot() const {
+  uint64_t samples = 0, bytes = 0, lost = 0;
+  py::list per_cpu;
+  for (size_t i = 0; i < num_cpus_; ++i) {
+    const auto &c = cpus_[i];
+    uint64_t cpu_samples = c.samples.load(std::memory_order_relaxed);
+    uint64_t cpu_bytes = c.bytes.load(std::memory_order_relaxed);
+    uint64_t cpu_lost = c.lost.load(std::memory_order_relaxed);
+    samples += cpu_samples;
+    bytes += cpu_bytes;
+    lost += cpu_lost;
+
+    py::dict entry;
+    entry["samples"] = cpu_samples;
+    entry["bytes"] = cpu_bytes;
+    entry["lost"] = cpu_lost;
+    per_cpu.append(entry);
+  }
+
+  // Only non-empty buckets, as (low_ns, high_ns, count)
+  py::list histogram;
+  for (size_t i = 0; i < kHistogramBuckets; ++i) {
+    uint64_t count = latency_[i].load(std::memory_order_relaxed);
+    if (count) {
+      uint64_t low = i ? uint64_t{1} << i : 0;
+      uint64_t high = i + 1 < 64 ? uint64_t{1} << (i + 1) : UINT64_MAX;
+      histogram.append(py::make_tuple(low, high, count));
+    }
+  }
+
+  py::dict stats;
+  stats["samples"] = samples;
+  stats["bytes"] = bytes;
+  stats["lost"] = lost;
+  stats["polls"] = polls_.load(std::memory_order_relaxed);
+  stats["poll_ns"] = poll_ns_.load(std::memory_order_relaxed);
+  stats["callbacks"] = callbacks_.load(std::memory_order_relaxed);
+  stats["callback_ns"] = callback_ns_.load(std::memory_order_relaxed);
+  stats["decode_ns"] = decode_ns_.load(std::memory_order_relaxed);
+  stats["gil_wait_ns"] = gil_wait_ns_.load(std::memory_order_relaxed);
+  stats["per_cpu"] = per_cpu;
+  stats["callback_latency_ns"] = histogram;
+  return stats;
+}
+
+void ConsumerStats::reset() {
+  for (size_t i = 0; i < num_cpus_; ++i) {
+    cpus_[i].samples.store(0, std::memory_order_relaxed);
+    cpus_[i].bytes.store(0, std::memory_order_relaxed);
+    cpus_[i].lost.store(0, std::memory_order_relaxed);
+  }
+  for (auto *counter : {&polls_, &poll_ns_, &callbacks_, &callback_ns_,
+                        &decode_ns_, &gil_wait_ns_}) {
+    counter->store(0, std::memory_order_relaxed);
+  }
+  for (auto &bucket : latency_) {
+    bucket.store(0, std::memory_order_relaxed);
+  }
+}
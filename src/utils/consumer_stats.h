@@ -0,0 +1,73 @@
+#ifndef PYLIBBPF_CONSUMER_STATS_H
+#define PYLIBBPF_CONSUMER_STATS_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <pybind11/pybind11.h>
+
+namespace py = pybind11;
+
+/**
+ * ConsumerStats - Lock-free counters for an event consumer.
+ *
+ * Per-CPU sample/byte/loss counters live on their own cache lines; every
+ * update is a relaxed atomic add, so reader threads and the polling thread
+ * never contend. Callback durations feed a log2 histogram in nanoseconds.
+ */
+class ConsumerStats {
+public:
+  static constexpr size_t kHistogramBuckets = 64;
+
+private:
+  struct alignas(64) CpuCounters {
+    std::atomic<uint64_t> samples{0};
+    std::atomic<uint64_t> bytes{0};
+    std::atomic<uint64_t> lost{0};
+  };
+
+  size_t num_cpus_;
+  std::unique_ptr<CpuCounters[]> cpus_;
+
+  std::atomic<uint64_t> polls_{0};
+  std::atomic<uint64_t> poll_ns_{0};
+  std::atomic<uint64_t> callbacks_{0};
+  std::atomic<uint64_t> callback_ns_{0};
+  std::atomic<uint64_t> decode_ns_{0};
+  std::atomic<uint64_t> gil_wait_ns_{0};
+  std::array<std::atomic<uint64_t>, kHistogramBuckets> latency_{};
+
+  CpuCounters &counters(int cpu) {
+    return cpus_[static_cast<size_t>(cpu) < num_cpus_ ? cpu : num_cpus_ - 1];
+  }
+
+public:
+  explicit ConsumerStats(int num_cpus);
+
+  void record_sample(int cpu, size_t bytes) {
+    auto &c = counters(cpu);
+    c.samples.fetch_add(1, std::memory_order_relaxed);
+    c.bytes.fetch_add(bytes, std::memory_order_relaxed);
+  }
+  void record_lost(int cpu, uint64_t count) {
+    counters(cpu).lost.fetch_add(count, std::memory_order_relaxed);
+  }
+  void record_poll(uint64_t ns) {
+    polls_.fetch_add(1, std::memory_order_relaxed);
+    poll_ns_.fetch_add(ns, std::memory_order_relaxed);
+  }
+  void record_decode(uint64_t ns) {
+    decode_ns_.fetch_add(ns, std::memory_order_relaxed);
+  }
+  void record_callback(uint64_t gil_wait_ns, uint64_t callback_ns);
+
+  /**
+   * Point-in-time copy of all counters. Values are read individually, so
+   * totals may be off by in-flight events.
+   */
+  [[nodiscard]] py::dict snapshot() const;
+  void reset();
+};
+
+#endif // PYLIBBPF_CONSUMER_STATS_H
@@ -0,0 +1,325 @@
+#include "utils/event_filter.h"
+#include "core/bpf_exception.h"
+#include "utils/struct_parser.h"
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+
+namespace {
+
+EventFilter::Op parse_op(const std::string &op) {
+  if (op == "==")
+    return EventFilter::Op::Eq;
+  if (op == "!=")
+    return EventFilter::Op::Ne;
+  if (op == "<")
+    return EventFilter::Op::Lt;
+  if (op == "<=")
+    return EventFilter::Op::Le;
+  if (op == ">")
+    return EventFilter::Op::Gt;
+  if (op == ">=")
+    return EventFilter::Op::Ge;
+  if (op == "in")
+    return EventFilter::Op::In;
+  if (op == "not in")
+    return EventFilter::Op::NotIn;
+  throw BpfException("Unknown filter operator '" + op + "'");
+}
+
+std::string to_string_value(py::handle value) {
+  if (py::isinstance<py::str>(value)) {
+    return value.cast<std::string>();
+  }
+  if (py::isinstance<py::bytes>(value)) {
+    return std::string(value.cast<py::bytes>());
+  }
+  throw BpfException("String fields compare against str or bytes");
+}
+
+template <typename T> bool compare(EventFilter::Op op, T lhs, T rhs) {
+  switch (op) {
+  case EventFilter::Op::Eq:
+    return lhs == rhs;
+  case EventFilter::Op::Ne:
+    return lhs != rhs;
+  case EventFilter::Op::Lt:
+    return lhs < rhs;
+  case EventFilter::Op::Le:
+    return lhs <= rhs;
+  case EventFilter::Op::Gt:
+    return lhs > rhs;
+  case EventFilter::Op::Ge:
+    return lhs >= rhs;
+  default:
+    return false;
+  }
+}
+
+template <typename T>
+bool test_value(EventFilter::Op op, T value, const std::vector<T> &values) {
+  if (op == EventFilter::Op::In || op == EventFilter::Op::NotIn) {
+    bool found = std::binary_search(values.begin(), values.end(), value);
+    return found == (op == EventFilter::Op::In);
+  }
+  return compare(op, value, values.front());
+}
+
+} // namespace
+
+// ==================== Predicate ====================
+
+EventFilter::Predicate::Predicate(
+    const std::vector<std::tuple<std::string, Op, py::object>> &conditions,
+    const ColumnLayout *layout) {
+  if (!conditions.empty() && !layout) {
+    throw BpfException("Field conditions need a struct_name to resolve");
+  }
+
+  for (const auto &[field, op, value] : conditions) {
+    const auto &columns = layout->columns();
+    auto it = std::find_if(columns.begin(), columns.end(),
+                           [&](const auto &col) { return col.name == field; });
+    if (it == columns.end()) {
+      throw BpfException("Unknown filter field '" + field + "'");
+    }
+    if (it->count) {
+      throw BpfException("Cannot filter on array field '" + field + "'");
+    }
+
+    Test test{*it, op, Kind::Signed, {}, {}, {}, {}};
+    const char fmt = it->format.back();
+    if (fmt == 's') {
+      test.kind = Kind::String;
+    } else if (fmt == 'f' || fmt == 'd') {
+      test.kind = Kind::Float;
+    } else if (!it->is_signed) {
+      test.kind = Kind::Unsigned;
+    }
+
+    if (test.kind == Kind::String && op != Op::Eq && op != Op::Ne &&
+        op != Op::In && op != Op::NotIn) {
+      throw BpfException("String field '" + field +
+                         "' only supports ==, !=, in and not in");
+    }
+
+    // Normalise to a list of operands; membership tests use all of them
+    py::list operands;
+    if (op == Op::In || op == Op::NotIn) {
+      for (auto item : value) {
+        operands.append(item);
+      }
+    } else {
+      operands.append(value);
+    }
+
+    for (auto item : operands) {
+      switch (test.kind) {
+      case Kind::Signed:
+        test.ints.push_back(item.cast<int64_t>());
+        break;
+      case Kind::Unsigned:
+        test.uints.push_back(item.cast<uint64_t>());
+        break;
+      case Kind::Float:
+        test.floats.push_back(item.cast<double>());
+        break;
+      case Kind::String:
+        test.strings.push_back(to_string_value(item));
+        break;
+      }
+    }
+    std::sort(test.ints.begin(), test.ints.end());
+    std::sort(test.uints.begin(), test.uints.end());
+    std::sort(test.floats.begin(), test.floats.end());
+    std::sort(test.strings.begin(), test.strings.end());
+
+    size_t end = it->bitfield_size
+                     ? (it->bit_offset + it->bitfield_size + 7) / 8
+                     : it->bit_offset / 8 + it->item_size;
+    min_size_ = std::max(min_size_, end);
+    tests_.push_back(std::move(test));
+  }
+}
+
+bool EventFilter::Predicate::matches(const void *data, size_t size) const {
+  if (size < min_size_) {
+    return false;
+  }
+
+  const auto *bytes = static_cast<const uint8_t *>(data);
+  return std::all_of(tests_.begin(), tests_.end(),
+                     [&](const Test &test) { return eval(test, bytes); });
+}
+
+bool EventFilter::Predicate::eval(const Test &test, const uint8_t *data) {
+  const auto &col = test.column;
+  const uint8_t *src = data + col.bit_offset / 8;
+
+  if (test.kind == Kind::String) {
+    std::string_view field(reinterpret_cast<const char *>(src),
+                           col.item_size);
+    if (col.trim_nul) {
+      field = field.substr(0, strnlen(field.data(), field.size()));
+    }
+
+    bool found = std::binary_search(test.strings.begin(), test.strings.end(),
+                                    field);
+    bool want = test.op == Op::Eq || test.op == Op::In;
+    return found == want;
+  }
+
+  if (test.kind == Kind::Float) {
+    double value;
+    if (col.item_size == sizeof(float)) {
+      float f;
+      std::memcpy(&f, src, sizeof(f));
+      value = f;
+    } else {
+      std::memcpy(&value, src, sizeof(value));
+    }
+    return test_value(test.op, value, test.floats);
+  }
+
+  uint64_t raw = 0;
+  if (col.bitfield_size) {
+    raw = BtfCodec::extract_bitfield(data, col.bit_offset, col.bitfield_size,
+                                     col.is_signed);
+  } else {
+    std::memcpy(&raw, src, col.item_size);
+    if (col.is_signed && col.item_size < sizeof(raw)) {
+      const unsigned shift = 64 - col.item_size * 8;
+      raw = static_cast<uint64_t>(static_cast<int64_t>(raw << shift) >>
+                                  shift);
+    }
+  }
+
+  if (test.kind == Kind::Signed) {
+    return test_value(test.op, static_cast<int64_t>(raw), test.ints);
+  }
+  return test_value(test.op, raw, test.uints);
+}
+
+// ==================== EventFilter ====================
+
+EventFilter::EventFilter()
+    : sample_every_(1), sample_seen_(0), interval_ns_(0), tolerance_ns_(0),
+      arrival_ns_(0), passed_(0), filtered_(0), sampled_out_(0),
+      rate_limited_(0) {}
+
+EventFilter &EventFilter::where(const std::string &field,
+                                const std::string &op, py::object value) {
+  conditions_.emplace_back(field, parse_op(op), std::move(value));
+  return *this;
+}
+
+EventFilter &EventFilter::sample(uint64_t every_n) {
+  if (every_n == 0) {
+    throw BpfException("every_n must be at least 1");
+  }
+  sample_every_.store(every_n, std::memory_order_relaxed);
+  return *this;
+}
+
+EventFilter &EventFilter::rate_limit(double events_per_sec, double burst) {
+  if (events_per_sec < 0 || burst < 0) {
+    throw BpfException("Rate limit must not be negative");
+  }
+
+  if (burst > 0 && burst < 1) {
+    throw BpfException("burst must be at least one event");
+  }
+
+  // Below 1/s a one-second burst would never hold a whole token
+  const double tokens = burst > 0 ? burst : std::max(1.0, events_per_sec);
+  // Clamped so the arrival-time arithmetic cannot overflow
+  constexpr double kMaxNs = 1e18;
+  const double interval =
+      events_per_sec > 0 ? std::clamp(1e9 / events_per_sec, 1.0, kMaxNs) : 0;
+
+  // A racing admit() may pair the new interval with the old tolerance for
+  // one event; the bucket is consistent again from the next one
+  arrival_ns_.store(0, std::memory_order_relaxed);
+  tolerance_ns_.store(
+      static_cast<int64_t>(std::min((tokens - 1) * interval, kMaxNs)),
+      std::memory_order_relaxed);
+  interval_ns_.store(static_cast<int64_t>(interval), std::memory_order_release);
+  return *this;
+}
+
+std::shared_ptr<const EventFilter::Predicate>
+EventFilter::bind(const ColumnLayout *layout) const {
+  return std::make_shared<Predicate>(conditions_, layout);
+}
+
+std::shared_ptr<const EventFilter::Predicate>
+EventFilter::bind(const StructParser *parser,
+                  const std::string &struct_name) const {
+  if (conditions_.empty() || struct_name.empty()) {
+    return bind(nullptr);
+  }
+
+  auto codec = parser ? parser->get_codec(struct_name) : nullptr;
+  if (!codec) {
+    throw BpfException("Field conditions need a BTF-described struct_name");
+  }
+  ColumnLayout layout(*codec);
+  return bind(&layout);
+}
+
+bool EventFilter::take_token() {
+  const int64_t interval = interval_ns_.load(std::memory_order_acquire);
+  if (interval <= 0) {
+    return true; // Disabled since admit() checked
+  }
+  const int64_t tolerance = tolerance_ns_.load(std::memory_order_relaxed);
+  const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                          std::chrono::steady_clock::now().time_since_epoch())
+                          .count();
+
+  // Each event pushes the arrival time one interval further; an event is
+  // over the limit when that runs more than `tolerance` ahead of now
+  int64_t arrival = arrival_ns_.load(std::memory_order_relaxed);
+  while (true) {
+    const int64_t start = std::max(arrival, now);
+    if (start - now > tolerance) {
+      return false;
+    }
+    if (arrival_ns_.compare_exchange_weak(arrival, start + interval,
+                                          std::memory_order_relaxed)) {
+      return true;
+    }
+  }
+}
+
+bool EventFilter::admit(const Predicate &predicate, const void *data,
+                        size_t size) {
+  if (!predicate.matches(data, size)) {
+    filtered_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  const uint64_t every = sample_every_.load(std::memory_order_relaxed);
+  if (every > 1 &&
+      sample_seen_.fetch_add(1, std::memory_order_relaxed) % every) {
+    sampled_out_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  if (interval_ns_.load(std::memory_order_relaxed) > 0 && !take_token()) {
+    rate_limited_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  passed_.fetch_add(1, std::memory_order_relaxed);
+  return true;
+}
+
+py::dict EventFilter::get_stats() const {
+  py::dict stats;
+  stats["passed"] = passed_.load(std::memory_order_relaxed);
+  stats["filtered"] = filtered_.load(std::memory_order_relaxed);
+  stats["sampled_out"] = sampled_out_.load(std::memory_order_relaxed);
+  stats["rate_limited"] = rate_limited_.load(std::memory_order_relaxed);
+  return stats;
+}
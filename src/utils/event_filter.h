@@ -0,0 +1,104 @@
+#ifndef PYLIBBPF_EVENT_FILTER_H
+#define PYLIBBPF_EVENT_FILTER_H
+
+#include "utils/column_batch.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <pybind11/pybind11.h>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace py = pybind11;
+
+class StructParser;
+
+/**
+ * EventFilter - Declarative filter applied to raw samples before the GIL
+ * is taken.
+ *
+ * Field comparisons run first, then 1-in-N sampling, then the token bucket
+ * rate limit. Field names are resolved against the consumer's struct when
+ * the filter is installed; later where() calls need a reinstall.
+ */
+class EventFilter {
+public:
+  enum class Op { Eq, Ne, Lt, Le, Gt, Ge, In, NotIn };
+
+  // Conditions resolved against one struct layout
+  class Predicate {
+  private:
+    enum class Kind { Signed, Unsigned, Float, String };
+    struct Test {
+      ColumnLayout::Column column;
+      Op op;
+      Kind kind;
+      std::vector<int64_t> ints;
+      std::vector<uint64_t> uints;
+      std::vector<double> floats;
+      std::vector<std::string> strings;
+    };
+    std::vector<Test> tests_;
+    size_t min_size_ = 0;
+
+    static bool eval(const Test &test, const uint8_t *data);
+
+  public:
+    Predicate(const std::vector<std::tuple<std::string, Op, py::object>>
+                  &conditions,
+              const ColumnLayout *layout);
+    [[nodiscard]] bool matches(const void *data, size_t size) const;
+  };
+
+private:
+  std::vector<std::tuple<std::string, Op, py::object>> conditions_;
+
+  // sample() and rate_limit() may run while reader threads admit events
+  std::atomic<uint64_t> sample_every_;
+  std::atomic<uint64_t> sample_seen_;
+
+  // Token bucket kept as a GCRA "theoretical arrival time", so admit()
+  // updates it with a CAS instead of a lock. interval_ns_ is the time one
+  // token takes to refill (0 = unlimited); tolerance_ns_ is how far ahead
+  // of now the arrival time may run, i.e. burst - 1 tokens.
+  std::atomic<int64_t> interval_ns_;
+  std::atomic<int64_t> tolerance_ns_;
+  std::atomic<int64_t> arrival_ns_;
+
+  std::atomic<uint64_t> passed_;
+  std::atomic<uint64_t> filtered_;
+  std::atomic<uint64_t> sampled_out_;
+  std::atomic<uint64_t> rate_limited_;
+
+  bool take_token();
+
+public:
+  EventFilter();
+
+  EventFilter &where(const std::string &field, const std::string &op,
+                     py::object value);
+  // Keep one of every n matching events (1 keeps all)
+  EventFilter &sample(uint64_t every_n);
+  // At most events_per_sec on average (0 = unlimited), bursts of up to
+  // `burst` events (0 = one second's worth, at least one event; an
+  // explicit burst must be at least 1)
+  EventFilter &rate_limit(double events_per_sec, double burst = 0);
+
+  /**
+   * Resolve the conditions against a struct layout. Pass nullptr for raw
+   * events, which only supports sampling and rate limiting.
+   */
+  [[nodiscard]] std::shared_ptr<const Predicate>
+  bind(const ColumnLayout *layout) const;
+  [[nodiscard]] std::shared_ptr<const Predicate>
+  bind(const StructParser *parser, const std::string &struct_name) const;
+
+  // Called without the GIL from poll and reader threads
+  bool admit(const Predicate &predicate, const void *data, size_t size);
+
+  [[nodiscard]] py::dict get_stats() const;
+};
+
+#endif // PYLIBBPF_EVENT_FILTER_H
@@ -0,0 +1,194 @@
+#include "utils/event_queue.h"
+#include "core/bpf_exception.h"
+#include <bit>
+#include <cstring>
+#include <thread>
+
+EventQueue::EventQueue(size_t capacity, OverflowPolicy policy,
+                       size_t slot_size)
+    : mask_(0), slot_size_(slot_size), policy_(policy), enqueue_pos_(0),
+      dequeue_pos_(0), closed_(false), consumer_waiting_(false), enqueued_(0),
+      dropped_oldest_(0), dropped_newest_(0), blocked_(0) {
+  if (capacity < 2) {
+    throw BpfException("Event queue capacity must be at least 2");
+  }
+
+  const size_t size = std::bit_ceil(capacity);
+  mask_ = size - 1;
+  cells_ = std::make_unique<Cell[]>(size);
+  for (size_t i = 0; i < size; ++i) {
+    cells_[i].sequence.store(i, std::memory_order_relaxed);
+  }
+  arena_ = std::make_unique<uint8_t[]>(size * slot_size_);
+}
+
+EventQueue::Cell *EventQueue::claim_enqueue(size_t &pos) {
+  pos = enqueue_pos_.load(std::memory_order_relaxed);
+
+  while (true) {
+    Cell *cell = &cells_[pos & mask_];
+    const size_t seq = cell->sequence.load(std::memory_order_acquire);
+    const auto diff =
+        static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+
+    if (diff == 0) {
+      if (enqueue_pos_.compare_exchange_weak(pos, pos + 1,
+                                             std::memory_order_relaxed))
+        return cell;
+    } else if (diff < 0) {
+      return nullptr; // Full
+    } else {
+      pos = enqueue_pos_.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+EventQueue::Cell *EventQueue::claim_dequeue(size_t &pos) {
+  pos = dequeue_pos_.load(std::memory_order_relaxed);
+
+  while (true) {
+    Cell *cell = &cells_[pos & mask_];
+    const size_t seq = cell->sequence.load(std::memory_order_acquire);
+    const auto diff =
+        static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+
+    if (diff == 0) {
+      if (dequeue_pos_.compare_exchange_weak(pos, pos + 1,
+                                             std::memory_order_relaxed))
+        return cell;
+    } else if (diff < 0) {
+      return nullptr; // Empty
+    } else {
+      pos = dequeue_pos_.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+bool EventQueue::try_enqueue(int cpu, const void *data, size_t size) {
+  size_t pos;
+  Cell *cell = claim_enqueue(pos);
+  if (!cell)
+    return false;
+
+  cell->cpu = cpu;
+  cell->size = size;
+  if (size <= slot_size_) {
+    std::memcpy(&arena_[(pos & mask_) * slot_size_], data, size);
+  } else {
+    const auto *bytes = static_cast<const uint8_t *>(data);
+    cell->spill.assign(bytes, bytes + size);
+  }
+  cell->sequence.store(pos + 1, std::memory_order_release);
+  return true;
+}
+
+bool EventQueue::try_pop(QueuedEvent &event) {
+  size_t pos;
+  Cell *cell = claim_dequeue(pos);
+  if (!cell)
+    return false;
+
+  const uint8_t *bytes = cell->size <= slot_size_
+                             ? &arena_[(pos & mask_) * slot_size_]
+                             : cell->spill.data();
+  event.cpu = cell->cpu;
+  event.data.assign(bytes, bytes + cell->size);
+  cell->sequence.store(pos + mask_ + 1, std::memory_order_release);
+  return true;
+}
+
+bool EventQueue::try_discard() {
+  size_t pos;
+  Cell *cell = claim_dequeue(pos);
+  if (!cell)
+    return false;
+
+  cell->sequence.store(pos + mask_ + 1, std::memory_order_release);
+  return true;
+}
+
+bool EventQueue::push(int cpu, const void *data, size_t size) {
+  bool queued = try_enqueue(cpu, data, size);
+
+  if (!queued) {
+    switch (policy_) {
+    case OverflowPolicy::DropNewest:
+      dropped_newest_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+
+    case OverflowPolicy::DropOldest:
+      // Act as a consumer to evict the head, then retry
+      while (!queued) {
+        if (try_discard())
+          dropped_oldest_.fetch_add(1, std::memory_order_relaxed);
+        queued = try_enqueue(cpu, data, size);
+      }
+      break;
+
+    case OverflowPolicy::Block:
+      blocked_.fetch_add(1, std::memory_order_relaxed);
+      while (!queued) {
+        if (closed_.load(std::memory_order_acquire)) {
+          dropped_newest_.fetch_add(1, std::memory_order_relaxed);
+          return false;
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+        queued = try_enqueue(cpu, data, size);
+      }
+      break;
+    }
+  }
+
+  enqueued_.fetch_add(1, std::memory_order_relaxed);
+
+  // Pairs with the fence in pop_wait so a parked consumer is never missed
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (consumer_waiting_.load(std::memory_order_relaxed)) {
+    std::lock_guard<std::mutex> lock(wait_mutex_);
+    wait_cv_.notify_all();
+  }
+  return true;
+}
+
+bool EventQueue::pop_wait(QueuedEvent &event,
+                          std::chrono::milliseconds timeout) {
+  if (try_pop(event))
+    return true;
+
+  const auto deadline = std::chrono::steady_clock::now() + timeout;
+  std::unique_lock<std::mutex> lock(wait_mutex_);
+
+  while (true) {
+    consumer_waiting_.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (try_pop(event)) {
+      consumer_waiting_.store(false, std::memory_order_relaxed);
+      return true;
+    }
+    if (closed_.load(std::memory_order_acquire))
+      break;
+
+    if (timeout.count() < 0) {
+      wait_cv_.wait(lock);
+    } else if (wait_cv_.wait_until(lock, deadline) ==
+               std::cv_status::timeout) {
+      break;
+    }
+  }
+
+  consumer_waiting_.store(false, std::memory_order_relaxed);
+  return try_pop(event);
+}
+
+void EventQueue::close() {
+  closed_.store(true, std::memory_order_release);
+  std::lock_guard<std::mutex> lock(wait_mutex_);
+  wait_cv_.notify_all();
+}
+
+size_t EventQueue::size() const {
+  const size_t head = dequeue_pos_.load(std::memory_order_relaxed);
+  const size_t tail = enqueue_pos_.load(std::memory_order_relaxed);
+  return tail > head ? tail - head : 0;
+}
@@ -0,0 +1,111 @@
+#ifndef PYLIBBPF_EVENT_QUEUE_H
+#define PYLIBBPF_EVENT_QUEUE_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// What a producer does when the queue is full
+enum class OverflowPolicy { DropOldest, DropNewest, Block };
+
+struct QueuedEvent {
+  int cpu = -1;
+  std::vector<uint8_t> data;
+};
+
+/**
+ * EventQueue - Bounded lock-free MPMC queue handing raw samples from native
+ * reader threads to Python.
+ *
+ * Based on Dmitry Vyukov's bounded queue: producers and consumers only
+ * touch per-cell sequence numbers on the hot path. The mutex/condvar pair
+ * is used solely to park a consumer that found the queue empty.
+ *
+ * Payloads are copied into a fixed-size slot per cell, carved out of one
+ * arena allocated up front, so producers never allocate. Samples larger
+ * than a slot spill into a per-cell buffer that keeps its capacity.
+ */
+class EventQueue {
+private:
+  struct Cell {
+    std::atomic<size_t> sequence;
+    int cpu = -1;
+    size_t size = 0;
+    std::vector<uint8_t> spill;
+  };
+
+  std::unique_ptr<Cell[]> cells_;
+  size_t mask_;
+  size_t slot_size_;
+  std::unique_ptr<uint8_t[]> arena_;
+  OverflowPolicy policy_;
+
+  alignas(64) std::atomic<size_t> enqueue_pos_;
+  alignas(64) std::atomic<size_t> dequeue_pos_;
+
+  std::atomic<bool> closed_;
+  std::atomic<bool> consumer_waiting_;
+  std::mutex wait_mutex_;
+  std::condition_variable wait_cv_;
+
+  std::atomic<uint64_t> enqueued_;
+  std::atomic<uint64_t> dropped_oldest_;
+  std::atomic<uint64_t> dropped_newest_;
+  std::atomic<uint64_t> blocked_;
+
+  // Claim the next cell to fill/drain, or nullptr if full/empty
+  Cell *claim_enqueue(size_t &pos);
+  Cell *claim_dequeue(size_t &pos);
+
+  bool try_enqueue(int cpu, const void *data, size_t size);
+  // Pop the head without copying it out (DropOldest eviction)
+  bool try_discard();
+
+public:
+  static constexpr size_t kDefaultSlotSize = 128;
+
+  // Capacity is rounded up to the next power of two
+  EventQueue(size_t capacity, OverflowPolicy policy,
+             size_t slot_size = kDefaultSlotSize);
+
+  EventQueue(const EventQueue &) = delete;
+  EventQueue &operator=(const EventQueue &) = delete;
+
+  /**
+   * Copy a sample in, applying the overflow policy when full.
+   * Returns false if the sample was dropped.
+   */
+  bool push(int cpu, const void *data, size_t size);
+
+  // Copies out into event.data, reusing its capacity
+  bool try_pop(QueuedEvent &event);
+
+  /**
+   * Pop an event, waiting up to `timeout` for one to arrive.
+   * A negative timeout waits until an event arrives or the queue closes.
+   */
+  bool pop_wait(QueuedEvent &event, std::chrono::milliseconds timeout);
+
+  // Wake all waiters; blocked producers give up and drop their event
+  void close();
+
+  [[nodiscard]] size_t capacity() const { return mask_ + 1; }
+  [[nodiscard]] size_t slot_size() const { return slot_size_; }
+  [[nodiscard]] size_t size() const;
+  [[nodiscard]] OverflowPolicy policy() const { return policy_; }
+  [[nodiscard]] uint64_t enqueued() const { return enqueued_.load(); }
+  [[nodiscard]] uint64_t dropped_oldest() const {
+    return dropped_oldest_.load();
+  }
+  [[nodiscard]] uint64_t dropped_newest() const {
+    return dropped_newest_.load();
+  }
+  [[nodiscard]] uint64_t blocked() const { return blocked_.load(); }
+};
+
+#endif // PYLIBBPF_EVENT_QUEUE_H
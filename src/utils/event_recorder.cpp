@@ -0,0 +1,316 @@
+#include "utils/event_recorder.h"
+#include "core/bpf_exception.h"
+#include "utils/struct_parser.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+
+namespace {
+
+uint64_t monotonic_ns() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + ts.tv_nsec;
+}
+
+// Invoke fn(header, payload) for each complete record in a segment
+template <typename Fn>
+bool for_each_record(const void *base, size_t size, Fn &&fn) {
+  using namespace event_record;
+  const auto *data = static_cast<const uint8_t *>(base);
+  size_t pos = sizeof(SegmentHeader);
+
+  while (pos + sizeof(RecordHeader) <= size) {
+    RecordHeader header;
+    std::memcpy(&header, data + pos, sizeof(header));
+    pos += sizeof(header);
+
+    // A truncated tail (e.g. after a crash) ends the segment
+    if (pos + header.size > size) {
+      break;
+    }
+    if (!fn(header, data + pos)) {
+      return false;
+    }
+    pos += padded(header.size);
+  }
+  return true;
+}
+
+} // namespace
+
+std::string event_record::segment_path(const std::string &path,
+                                       size_t index) {
+  char suffix[16];
+  std::snprintf(suffix, sizeof(suffix), ".%06zu", index);
+  return path + suffix;
+}
+
+// ==================== EventRecorder ====================
+
+EventRecorder::EventRecorder(std::string path, size_t segment_size,
+                             size_t buffer_size)
+    : path_(std::move(path)), segment_size_(segment_size),
+      buffer_size_(buffer_size), fd_(-1), segment_index_(0),
+      segment_bytes_(0), records_(0), bytes_(0) {
+  if (segment_size_ < buffer_size_) {
+    throw BpfException("segment_size must be at least buffer_size");
+  }
+  buffer_.reserve(buffer_size_);
+  open_segment();
+}
+
+EventRecorder::~EventRecorder() {
+  try {
+    close();
+  } catch (const BpfException &) {
+    // Nothing sensible to do with a write error during teardown
+  }
+}
+
+void EventRecorder::open_segment() {
+  if (fd_ >= 0) {
+    ::close(fd_);
+  }
+
+  std::string file = event_record::segment_path(path_, segment_index_++);
+  fd_ = ::open(file.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd_ < 0) {
+    throw BpfException("Failed to create '" + file +
+                       "': " + std::strerror(errno));
+  }
+
+  event_record::SegmentHeader header = {};
+  std::memcpy(header.magic, event_record::kMagic, sizeof(header.magic));
+  header.version = event_record::kVersion;
+  const auto *bytes = reinterpret_cast<const uint8_t *>(&header);
+  buffer_.insert(buffer_.end(), bytes, bytes + sizeof(header));
+  segment_bytes_ = sizeof(header);
+}
+
+void EventRecorder::write_buffer() {
+  size_t done = 0;
+  while (done < buffer_.size()) {
+    ssize_t n = ::write(fd_, buffer_.data() + done, buffer_.size() - done);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      buffer_.clear();
+      throw BpfException("Failed to write recording: " +
+                         std::string(std::strerror(errno)));
+    }
+    done += static_cast<size_t>(n);
+  }
+  buffer_.clear();
+}
+
+void EventRecorder::append(int cpu, const void *data, size_t size) {
+  event_record::RecordHeader header = {static_cast<uint32_t>(cpu),
+                                       static_cast<uint32_t>(size),
+                                       monotonic_ns()};
+  const size_t total = sizeof(header) + event_record::padded(size);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (fd_ < 0) {
+    return; // Closed, or stopped by an earlier write error
+  }
+
+  // Runs inside libbpf callbacks, so errors are parked, never thrown
+  try {
+    if (segment_bytes_ + total > segment_size_ &&
+        segment_bytes_ > sizeof(event_record::SegmentHeader)) {
+      write_buffer();
+      open_segment();
+    } else if (buffer_.size() + total > buffer_size_) {
+      write_buffer();
+    }
+  } catch (const BpfException &e) {
+    error_ = e.what();
+    if (fd_ >= 0) {
+      ::close(fd_);
+      fd_ = -1;
+    }
+    return;
+  }
+
+  const auto *hdr = reinterpret_cast<const uint8_t *>(&header);
+  const auto *payload = static_cast<const uint8_t *>(data);
+  buffer_.insert(buffer_.end(), hdr, hdr + sizeof(header));
+  buffer_.insert(buffer_.end(), payload, payload + size);
+  buffer_.resize(buffer_.size() + event_record::padded(size) - size, 0);
+
+  segment_bytes_ += total;
+  ++records_;
+  bytes_ += size;
+}
+
+void EventRecorder::flush() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!error_.empty()) {
+    throw BpfException("Recording stopped: " + error_);
+  }
+  if (fd_ >= 0) {
+    write_buffer();
+  }
+}
+
+void EventRecorder::close() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (fd_ < 0) {
+    return;
+  }
+
+  try {
+    write_buffer();
+  } catch (...) {
+    ::close(fd_);
+    fd_ = -1;
+    throw;
+  }
+  ::close(fd_);
+  fd_ = -1;
+}
+
+py::dict EventRecorder::get_stats() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  py::dict stats;
+  stats["records"] = records_;
+  stats["bytes"] = bytes_;
+  stats["segments"] = segment_index_;
+  stats["error"] = error_.empty() ? py::object(py::none())
+                                  : py::object(py::str(error_));
+  return stats;
+}
+
+// ==================== EventReplay ====================
+
+EventReplay::EventReplay(std::string path) : path_(std::move(path)) {
+  try {
+    while (map_segment(segments_.size())) {
+    }
+  } catch (...) {
+    unmap();
+    throw;
+  }
+
+  if (segments_.empty()) {
+    throw BpfException("No recording found at '" + path_ + "'");
+  }
+}
+
+bool EventReplay::map_segment(size_t index) {
+  std::string file = event_record::segment_path(path_, index);
+  int fd = ::open(file.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    if (errno == ENOENT) {
+      return false;
+    }
+    throw BpfException("Failed to open '" + file +
+                       "': " + std::strerror(errno));
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) < 0 || static_cast<size_t>(st.st_size) <
+                                sizeof(event_record::SegmentHeader)) {
+    ::close(fd);
+    throw BpfException("'" + file + "' is not a recording segment");
+  }
+
+  const auto size = static_cast<size_t>(st.st_size);
+  void *base = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  int err = errno;
+  ::close(fd);
+  if (base == MAP_FAILED) {
+    throw BpfException("Failed to map '" + file + "': " + std::strerror(err));
+  }
+
+  const auto *header = static_cast<const event_record::SegmentHeader *>(base);
+  if (std::memcmp(header->magic, event_record::kMagic,
+                  sizeof(header->magic)) != 0 ||
+      header->version != event_record::kVersion) {
+    munmap(base, size);
+    throw BpfException("'" + file + "' is not a recording segment");
+  }
+
+  madvise(base, size, MADV_SEQUENTIAL);
+  segments_.push_back({base, size});
+  return true;
+}
+
+EventReplay::~EventReplay() { unmap(); }
+
+void EventReplay::unmap() {
+  for (const auto &segment : segments_) {
+    munmap(segment.base, segment.size);
+  }
+  segments_.clear();
+}
+
+size_t EventReplay::replay(py::function callback,
+                           const std::string &struct_name,
+                           std::shared_ptr<StructParser> parser,
+                           size_t max_events) {
+  if (!struct_name.empty() && !parser) {
+    throw BpfException("A StructParser is needed to decode '" + struct_name +
+                       "'");
+  }
+  if (!struct_name.empty()) {
+    parser->prepare(struct_name);
+  }
+
+  size_t count = 0;
+  for (const auto &segment : segments_) {
+    bool more = for_each_record(
+        segment.base, segment.size,
+        [&](const event_record::RecordHeader &header, const uint8_t *data) {
+          if (max_events && count >= max_events) {
+            return false;
+          }
+
+          py::object event;
+          if (!struct_name.empty()) {
+            event = parser->parse_raw(struct_name, data, header.size);
+          } else {
+            event = py::bytes(reinterpret_cast<const char *>(data),
+                              header.size);
+          }
+          callback(static_cast<int>(header.cpu), event);
+          ++count;
+          return true;
+        });
+    if (!more) {
+      break;
+    }
+  }
+  return count;
+}
+
+py::list EventReplay::read(size_t max_events) const {
+  py::list events;
+  size_t count = 0;
+  for (const auto &segment : segments_) {
+    bool more = for_each_record(
+        segment.base, segment.size,
+        [&](const event_record::RecordHeader &header, const uint8_t *data) {
+          if (max_events && count >= max_events) {
+            return false;
+          }
+          events.append(py::make_tuple(
+              static_cast<int>(header.cpu), header.timestamp_ns,
+              py::bytes(reinterpret_cast<const char *>(data), header.size)));
+          ++count;
+          return true;
+        });
+    if (!more) {
+      break;
+    }
+  }
+  return events;
+}
@@ -0,0 +1,126 @@
+#ifndef PYLIBBPF_EVENT_RECORDER_H
+#define PYLIBBPF_EVENT_RECORDER_H
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <pybind11/pybind11.h>
+#include <string>
+#include <vector>
+
+namespace py = pybind11;
+
+class StructParser;
+
+/**
+ * On-disk format shared by EventRecorder and EventReplay.
+ *
+ * A recording is a series of segment files "<path>.000000",
+ * "<path>.000001", ... Each starts with a SegmentHeader followed by
+ * records: a RecordHeader, then the payload padded to 8 bytes.
+ */
+namespace event_record {
+
+constexpr char kMagic[8] = {'P', 'Y', 'L', 'B', 'P', 'F', 'R', 'C'};
+constexpr uint32_t kVersion = 1;
+
+struct SegmentHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t reserved;
+};
+
+struct RecordHeader {
+  uint32_t cpu;
+  uint32_t size;
+  uint64_t timestamp_ns; // CLOCK_MONOTONIC at capture
+};
+
+inline size_t padded(size_t size) { return (size + 7) & ~size_t{7}; }
+
+std::string segment_path(const std::string &path, size_t index);
+
+} // namespace event_record
+
+/**
+ * EventRecorder - Native sink appending raw samples to segmented files.
+ *
+ * Records are gathered in a large in-memory buffer and written out in
+ * big chunks; a new segment starts once the current one exceeds
+ * segment_size. Safe to call from reader threads.
+ */
+class EventRecorder {
+private:
+  std::string path_;
+  size_t segment_size_;
+  size_t buffer_size_;
+
+  std::mutex mutex_;
+  int fd_;
+  size_t segment_index_;
+  size_t segment_bytes_;
+  std::vector<uint8_t> buffer_;
+
+  uint64_t records_;
+  uint64_t bytes_;
+  std::string error_;
+
+  void open_segment();
+  void write_buffer();
+
+public:
+  EventRecorder(std::string path, size_t segment_size = 256 << 20,
+                size_t buffer_size = 1 << 20);
+  ~EventRecorder();
+
+  EventRecorder(const EventRecorder &) = delete;
+  EventRecorder &operator=(const EventRecorder &) = delete;
+
+  void append(int cpu, const void *data, size_t size);
+  void flush();
+  void close();
+
+  [[nodiscard]] py::dict get_stats();
+};
+
+/**
+ * EventReplay - Memory-maps a recording and feeds it back through the
+ * usual callback/StructParser path, without a kernel.
+ */
+class EventReplay {
+private:
+  struct Segment {
+    void *base;
+    size_t size;
+  };
+
+  std::string path_;
+  std::vector<Segment> segments_;
+
+  // Map "<path>.<index>"; false once there are no more segments
+  bool map_segment(size_t index);
+  void unmap();
+
+public:
+  explicit EventReplay(std::string path);
+  ~EventReplay();
+
+  EventReplay(const EventReplay &) = delete;
+  EventReplay &operator=(const EventReplay &) = delete;
+
+  /**
+   * Call callback(cpu, event) for every record in capture order. Events
+   * are bytes, or decoded with `parser` when struct_name is given.
+   * Returns the number of records replayed.
+   */
+  size_t replay(py::function callback, const std::string &struct_name = "",
+                std::shared_ptr<StructParser> parser = nullptr,
+                size_t max_events = 0);
+
+  // Raw (cpu, timestamp_ns, bytes) tuples, capture order
+  [[nodiscard]] py::list read(size_t max_events = 0) const;
+
+  [[nodiscard]] size_t get_num_segments() const { return segments_.size(); }
+};
+
+#endif // PYLIBBPF_EVENT_RECORDER_H
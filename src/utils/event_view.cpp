@@ -0,0 +1,104 @@
+#include "utils/event_view.h"
+#include "core/bpf_exception.h"
+#include "utils/struct_parser.h"
+#include <utility>
+
+namespace {
+
+// One idle EventBuffer kept for reuse; only touched with the GIL held.
+// Deliberately leaked so it is never freed after the interpreter.
+py::object &spare_buffer() {
+  static auto *spare = new py::object();
+  return *spare;
+}
+
+} // namespace
+
+void EventBuffer::assign(const void *data, size_t size) {
+  const auto *bytes = static_cast<const uint8_t *>(data);
+  data_.assign(bytes, bytes + size);
+}
+
+py::buffer_info EventBuffer::buffer_info() {
+  return py::buffer_info(data_.data(), 1,
+                         py::format_descriptor<uint8_t>::format(), 1,
+                         {static_cast<py::ssize_t>(data_.size())}, {1},
+                         /*readonly=*/true);
+}
+
+EventView::EventView(const void *data, size_t size,
+                     std::shared_ptr<StructParser> parser,
+                     std::string struct_name)
+    : data_(data), size_(size), valid_(true), parser_(std::move(parser)),
+      struct_name_(std::move(struct_name)) {}
+
+void EventView::check_valid() const {
+  if (!valid_) {
+    throw BpfException("Event view used after its callback returned; "
+                       "call copy() to keep events");
+  }
+}
+
+py::object EventView::memoryview() {
+  check_valid();
+  if (!view_) {
+    buffer_ = std::exchange(spare_buffer(), py::object());
+    if (!buffer_) {
+      buffer_ = py::cast(std::make_shared<EventBuffer>());
+    }
+    buffer_.cast<std::shared_ptr<EventBuffer>>()->assign(data_, size_);
+    view_ = py::memoryview(buffer_);
+  }
+  return view_;
+}
+
+py::object EventView::as_struct() {
+  check_valid();
+  if (!parser_ || struct_name_.empty()) {
+    throw BpfException("No struct name configured for this event");
+  }
+
+  if (!struct_obj_) {
+    // BTF structs copy field values out and ctypes structs are built with
+    // from_buffer_copy, so nothing aliases the ring once we return
+    struct_obj_ = parser_->parse_raw(struct_name_, data_, size_);
+  }
+  return struct_obj_;
+}
+
+py::object EventView::copy() const {
+  check_valid();
+  py::bytes data = tobytes();
+  if (parser_ && !struct_name_.empty()) {
+    return parser_->parse(struct_name_, data);
+  }
+  return data;
+}
+
+py::bytes EventView::tobytes() const {
+  check_valid();
+  return py::bytes(static_cast<const char *>(data_), size_);
+}
+
+py::object EventView::getattr(const std::string &name) {
+  if (!parser_ || struct_name_.empty()) {
+    throw py::attribute_error("EventView has no attribute '" + name + "'");
+  }
+  return as_struct().attr(name.c_str());
+}
+
+void EventView::release() {
+  if (!valid_) {
+    return;
+  }
+  valid_ = false;
+
+  struct_obj_ = py::object();
+  view_ = py::object();
+  // Anything still derived from the memoryview keeps its own reference to
+  // the buffer; only one no one else holds can be refilled
+  if (buffer_ && buffer_.ref_count() == 1) {
+    spare_buffer() = std::move(buffer_);
+  }
+  buffer_ = py::object();
+}
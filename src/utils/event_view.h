@@ -0,0 +1,80 @@
+#ifndef PYLIBBPF_EVENT_VIEW_H
+#define PYLIBBPF_EVENT_VIEW_H
+
+#include <cstdint>
+#include <memory>
+#include <pybind11/pybind11.h>
+#include <string>
+#include <vector>
+
+class StructParser;
+
+namespace py = pybind11;
+
+/**
+ * EventBuffer - Read-only copy of a sample that EventView memoryviews are
+ * exported from.
+ *
+ * Everything derived from such a memoryview (slices, NumPy arrays, ctypes
+ * structs) holds a reference to the buffer, so it stays valid after the
+ * ring memory is reused. Buffers nothing references any more are recycled
+ * for the next view, keeping the copy free of allocations.
+ */
+class EventBuffer {
+private:
+  std::vector<uint8_t> data_;
+
+public:
+  void assign(const void *data, size_t size);
+  [[nodiscard]] py::buffer_info buffer_info();
+  [[nodiscard]] size_t size() const { return data_.size(); }
+};
+
+/**
+ * EventView - Handle on a sample that still lives in ring memory.
+ *
+ * Only valid for the duration of the callback it was passed to; the
+ * consumer releases it as soon as the callback returns. Field access and
+ * as_struct() decode straight from ring memory. memoryview() exports a
+ * staged copy instead (see EventBuffer), since a raw export would alias
+ * memory the kernel is about to reuse. Use copy() to keep an event around.
+ */
+class EventView {
+private:
+  const void *data_;
+  size_t size_;
+  bool valid_;
+
+  std::shared_ptr<StructParser> parser_;
+  std::string struct_name_;
+
+  py::object buffer_;     // EventBuffer backing view_
+  py::object view_;       // read-only memoryview over buffer_
+  py::object struct_obj_; // decoded struct, owns its data
+
+  void check_valid() const;
+
+public:
+  EventView(const void *data, size_t size,
+            std::shared_ptr<StructParser> parser = nullptr,
+            std::string struct_name = "");
+
+  EventView(const EventView &) = delete;
+  EventView &operator=(const EventView &) = delete;
+
+  [[nodiscard]] py::object memoryview();
+  // Struct decoded from ring memory, if a struct name was configured
+  [[nodiscard]] py::object as_struct();
+  // Owned copy: parsed struct if a struct name was configured, else bytes
+  [[nodiscard]] py::object copy() const;
+  [[nodiscard]] py::bytes tobytes() const;
+  [[nodiscard]] py::object getattr(const std::string &name);
+
+  [[nodiscard]] size_t size() const { return size_; }
+  [[nodiscard]] bool is_valid() const { return valid_; }
+
+  // Invalidate the view; its staged buffer is recycled unless still in use
+  void release();
+};
+
+#endif // PYLIBBPF_EVENT_VIEW_H
@@ -0,0 +1,48 @@
+#include "utils/map_buffer.h"
+#include <utility>
+
+MapBuffer::MapBuffer(std::vector<uint8_t> data, std::string format,
+                     size_t item_size, std::vector<py::ssize_t> shape,
+                     std::vector<py::ssize_t> strides)
+    : data_(std::move(data)), format_(std::move(format)),
+      item_size_(item_size), shape_(std::move(shape)),
+      strides_(std::move(strides)) {}
+
+MapBuffer MapBuffer::records(std::vector<uint8_t> data, size_t count,
+                             size_t record_size) {
+  data.resize(count * record_size);
+
+  std::string format = uint_format(record_size);
+  if (!format.empty()) {
+    return MapBuffer(std::move(data), format, record_size,
+                     {static_cast<py::ssize_t>(count)},
+                     {static_cast<py::ssize_t>(record_size)});
+  }
+
+  return MapBuffer(std::move(data), py::format_descriptor<uint8_t>::format(),
+                   1,
+                   {static_cast<py::ssize_t>(count),
+                    static_cast<py::ssize_t>(record_size)},
+                   {static_cast<py::ssize_t>(record_size), 1});
+}
+
+py::buffer_info MapBuffer::buffer_info() {
+  return py::buffer_info(data_.data(), static_cast<py::ssize_t>(item_size_),
+                         format_, static_cast<py::ssize_t>(shape_.size()),
+                         shape_, strides_);
+}
+
+std::string MapBuffer::uint_format(size_t size) {
+  switch (size) {
+  case 1:
+    return py::format_descriptor<uint8_t>::format();
+  case 2:
+    return py::format_descriptor<uint16_t>::format();
+  case 4:
+    return py::format_descriptor<uint32_t>::format();
+  case 8:
+    return py::format_descriptor<uint64_t>::format();
+  default:
+    return "";
+  }
+}
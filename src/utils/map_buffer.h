@@ -0,0 +1,49 @@
+#ifndef PYLIBBPF_MAP_BUFFER_H
+#define PYLIBBPF_MAP_BUFFER_H
+
+#include <cstdint>
+#include <pybind11/pybind11.h>
+#include <string>
+#include <vector>
+
+namespace py = pybind11;
+
+/**
+ * MapBuffer - Contiguous native storage exported through the Python buffer
+ * protocol.
+ *
+ * Used to hand whole map dumps to NumPy (or anything else that understands
+ * memoryviews) without building a Python object per entry.
+ */
+class MapBuffer {
+private:
+  std::vector<uint8_t> data_;
+  std::string format_;
+  size_t item_size_;
+  std::vector<py::ssize_t> shape_;
+  std::vector<py::ssize_t> strides_;
+
+public:
+  MapBuffer(std::vector<uint8_t> data, std::string format, size_t item_size,
+            std::vector<py::ssize_t> shape, std::vector<py::ssize_t> strides);
+
+  /**
+   * Build a buffer of `count` records, each `record_size` bytes long.
+   * Records of 1, 2, 4 or 8 bytes are exported as a 1-D unsigned integer
+   * array, anything else as a (count, record_size) byte matrix.
+   */
+  static MapBuffer records(std::vector<uint8_t> data, size_t count,
+                           size_t record_size);
+
+  [[nodiscard]] py::buffer_info buffer_info();
+  [[nodiscard]] size_t size() const {
+    return shape_.empty() ? 0 : static_cast<size_t>(shape_[0]);
+  }
+  [[nodiscard]] size_t nbytes() const { return data_.size(); }
+  [[nodiscard]] std::string get_format() const { return format_; }
+
+  // Format character for an unsigned integer of `size` bytes, or "" if none
+  static std::string uint_format(size_t size);
+};
+
+#endif // PYLIBBPF_MAP_BUFFER_H
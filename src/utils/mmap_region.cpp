@@ -0,0 +1,25 @@
+#include "utils/mmap_region.h"
+#include <sys/mman.h>
+#include <utility>
+
+MmapRegion::MmapRegion(void *addr, size_t length, bool owned, bool readonly,
+                       std::shared_ptr<void> owner, std::string format,
+                       size_t item_size, std::vector<py::ssize_t> shape,
+                       std::vector<py::ssize_t> strides)
+    : addr_(addr), length_(length), owned_(owned), readonly_(readonly),
+      owner_(std::move(owner)), format_(std::move(format)),
+      item_size_(item_size), shape_(std::move(shape)),
+      strides_(std::move(strides)) {}
+
+MmapRegion::~MmapRegion() {
+  if (owned_ && addr_) {
+    munmap(addr_, length_);
+    addr_ = nullptr;
+  }
+}
+
+py::buffer_info MmapRegion::buffer_info() {
+  return py::buffer_info(addr_, static_cast<py::ssize_t>(item_size_), format_,
+                         static_cast<py::ssize_t>(shape_.size()), shape_,
+                         strides_, readonly_);
+}
@@ -0,0 +1,47 @@
+#ifndef PYLIBBPF_MMAP_REGION_H
+#define PYLIBBPF_MMAP_REGION_H
+
+#include <cstddef>
+#include <memory>
+#include <pybind11/pybind11.h>
+#include <string>
+#include <vector>
+
+namespace py = pybind11;
+
+/**
+ * MmapRegion - A memory mapping shared with the kernel, exported through
+ * the Python buffer protocol.
+ *
+ * Either owns the mapping (and unmaps it on destruction) or borrows one
+ * owned by libbpf, in which case `owner` keeps that owner alive.
+ */
+class MmapRegion {
+private:
+  void *addr_;
+  size_t length_;
+  bool owned_;
+  bool readonly_;
+  std::shared_ptr<void> owner_;
+
+  std::string format_;
+  size_t item_size_;
+  std::vector<py::ssize_t> shape_;
+  std::vector<py::ssize_t> strides_;
+
+public:
+  MmapRegion(void *addr, size_t length, bool owned, bool readonly,
+             std::shared_ptr<void> owner, std::string format,
+             size_t item_size, std::vector<py::ssize_t> shape,
+             std::vector<py::ssize_t> strides);
+  ~MmapRegion();
+
+  MmapRegion(const MmapRegion &) = delete;
+  MmapRegion &operator=(const MmapRegion &) = delete;
+
+  [[nodiscard]] py::buffer_info buffer_info();
+  [[nodiscard]] bool is_readonly() const { return readonly_; }
+  [[nodiscard]] size_t size() const { return length_; }
+};
+
+#endif // PYLIBBPF_MMAP_REGION_H
@@ -0,0 +1,146 @@
+#include "utils/object_cache.h"
+#include <cstring>
+#include <utility>
+
+ObjectCache &ObjectCache::instance() {
+  static ObjectCache cache;
+  return cache;
+}
+
+ObjectCache::~ObjectCache() { clear(); }
+
+uint64_t ObjectCache::hash(std::span<const uint8_t> data,
+                           const std::string &name) {
+  // FNV-1a; hits are confirmed by comparing the bytes
+  uint64_t h = 0xcbf29ce484222325ULL;
+  auto mix = [&h](const uint8_t *p, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+      h ^= p[i];
+      h *= 0x100000001b3ULL;
+    }
+  };
+  mix(reinterpret_cast<const uint8_t *>(name.data()), name.size());
+  mix(data.data(), data.size());
+  return h;
+}
+
+struct bpf_object *ObjectCache::open_blob(const ObjectBlob &blob) {
+  LIBBPF_OPTS(bpf_object_open_opts, opts);
+  if (!blob.name.empty())
+    opts.object_name = blob.name.c_str();
+  return bpf_object__open_mem(blob.data.data(), blob.data.size(), &opts);
+}
+
+std::shared_ptr<const ObjectBlob>
+ObjectCache::intern(std::span<const uint8_t> data, const std::string &name) {
+  const uint64_t h = hash(data, name);
+
+  std::vector<Entry> evicted;
+  std::shared_ptr<const ObjectBlob> blob;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto [first, last] = entries_.equal_range(h);
+    for (auto it = first; it != last; ++it) {
+      const ObjectBlob &cached = *it->second.blob;
+      if (cached.name == name && cached.data.size() == data.size() &&
+          std::memcmp(cached.data.data(), data.data(), data.size()) == 0) {
+        it->second.last_used = ++clock_;
+        return it->second.blob;
+      }
+    }
+
+    blob = std::make_shared<const ObjectBlob>(
+        ObjectBlob{h, name, std::vector<uint8_t>(data.begin(), data.end())});
+    Entry entry;
+    entry.blob = blob;
+    entry.last_used = ++clock_;
+    entries_.emplace(h, std::move(entry));
+    evicted = evict_locked();
+  }
+
+  // Waiting for an in-flight spare must not hold up other callers
+  for (auto &entry : evicted)
+    discard(entry);
+  return blob;
+}
+
+std::vector<ObjectCache::Entry> ObjectCache::evict_locked() {
+  std::vector<Entry> evicted;
+  while (entries_.size() > kMaxEntries) {
+    auto oldest = entries_.begin();
+    for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+      if (it->second.last_used < oldest->second.last_used)
+        oldest = it;
+    }
+    evicted.push_back(std::move(oldest->second));
+    entries_.erase(oldest);
+  }
+  return evicted;
+}
+
+struct bpf_object *
+ObjectCache::open(const std::shared_ptr<const ObjectBlob> &blob) {
+  std::future<struct bpf_object *> spare;
+  Entry *entry = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto [first, last] = entries_.equal_range(blob->hash);
+    for (auto it = first; it != last; ++it) {
+      if (it->second.blob == blob) {
+        entry = &it->second;
+        break;
+      }
+    }
+    if (entry) {
+      entry->last_used = ++clock_;
+      spare = std::move(entry->spare);
+      // Blobs opened once never pay for a background parse; from the
+      // second open on, a spare is kept ready for the next one
+      if (++entry->opens > 1) {
+        entry->spare = std::async(std::launch::async,
+                                  [blob] { return open_blob(*blob); });
+      }
+    }
+  }
+
+  struct bpf_object *obj = spare.valid() ? spare.get() : nullptr;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (obj)
+      ++hits_;
+    else
+      ++misses_;
+  }
+  if (obj)
+    return obj;
+
+  // No spare, or it failed on another thread: open here so errno is ours
+  return open_blob(*blob);
+}
+
+void ObjectCache::discard(Entry &entry) {
+  if (!entry.spare.valid())
+    return;
+  if (struct bpf_object *obj = entry.spare.get())
+    bpf_object__close(obj);
+}
+
+void ObjectCache::clear() {
+  std::unordered_multimap<uint64_t, Entry> entries;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries.swap(entries_);
+    clock_ = hits_ = misses_ = 0;
+  }
+  for (auto &[hash, entry] : entries)
+    discard(entry);
+}
+
+py::dict ObjectCache::get_stats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  py::dict stats;
+  stats["entries"] = entries_.size();
+  stats["hits"] = hits_;
+  stats["misses"] = misses_;
+  return stats;
+}
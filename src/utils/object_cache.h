@@ -0,0 +1,83 @@
+#ifndef PYLIBBPF_OBJECT_CACHE_H
+#define PYLIBBPF_OBJECT_CACHE_H
+
+#include <cstdint>
+#include <future>
+#include <libbpf.h>
+#include <memory>
+#include <mutex>
+#include <pybind11/pybind11.h>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace py = pybind11;
+
+// An in-memory object file; BpfObjects opened from it keep it alive
+struct ObjectBlob {
+  uint64_t hash;
+  std::string name;
+  std::vector<uint8_t> data;
+};
+
+/**
+ * ObjectCache - Process-wide, content-addressed store of object blobs.
+ *
+ * A bpf_object can only be loaded once and libbpf has no way to clone a
+ * parsed one, so instead of sharing parsed state the cache keeps a spare
+ * object, opened on a background thread, for blobs that are opened again
+ * and again. Repeat instantiation then skips the ELF/BTF parse. Spares are
+ * only prepared once a blob is reopened and refilled when taken, and the
+ * least recently used blobs are dropped beyond kMaxEntries.
+ */
+class ObjectCache {
+public:
+  static constexpr size_t kMaxEntries = 64;
+
+  static ObjectCache &instance();
+
+  ObjectCache() = default;
+  ~ObjectCache();
+
+  ObjectCache(const ObjectCache &) = delete;
+  ObjectCache &operator=(const ObjectCache &) = delete;
+
+  // Equal bytes and name share one blob
+  std::shared_ptr<const ObjectBlob> intern(std::span<const uint8_t> data,
+                                           const std::string &name);
+
+  /**
+   * Return an opened, unloaded object for `blob` (nullptr with errno set on
+   * failure), taking the prepared spare if there is one and starting the
+   * next.
+   */
+  struct bpf_object *open(const std::shared_ptr<const ObjectBlob> &blob);
+
+  // Drop all blobs and close prepared objects
+  void clear();
+  [[nodiscard]] py::dict get_stats() const;
+
+  static uint64_t hash(std::span<const uint8_t> data, const std::string &name);
+  static struct bpf_object *open_blob(const ObjectBlob &blob);
+
+private:
+  struct Entry {
+    std::shared_ptr<const ObjectBlob> blob;
+    std::future<struct bpf_object *> spare;
+    uint64_t opens = 0;
+    uint64_t last_used = 0;
+  };
+
+  mutable std::mutex mutex_;
+  std::unordered_multimap<uint64_t, Entry> entries_;
+  uint64_t clock_ = 0;
+  uint64_t hits_ = 0, misses_ = 0;
+
+  // Called with mutex_ held; returns the evicted entry for closing
+  std::vector<Entry> evict_locked();
+
+  static void discard(Entry &entry);
+};
+
+#endif // PYLIBBPF_OBJECT_CACHE_H
@@ -1,7 +1,9 @@
 #include "struct_parser.h"
 #include "core/bpf_exception.h"
+#include <string_view>
 
-StructParser::StructParser(py::dict structs) {
+StructParser::StructParser(py::dict structs, const struct btf *btf)
+    : btf_(btf), format_(StructFormat::NamedTuple) {
   for (auto item : structs) {
     std::string name = py::str(item.first);
     struct_types_[name] = py::reinterpret_borrow<py::object>(item.second);
@@ -10,16 +12,55 @@ StructParser::StructParser(py::dict structs) {
 
 py::object StructParser::parse(const std::string &struct_name, py::bytes data) {
   auto it = struct_types_.find(struct_name);
-  if (it == struct_types_.end()) {
-    throw BpfException("Unknown struct: " + struct_name);
+  if (it != struct_types_.end()) {
+    // Use ctypes.from_buffer_copy() to create struct from bytes
+    return it->second.attr("from_buffer_copy")(data);
   }
 
-  py::object struct_type = it->second;
+  std::string_view view = data;
+  return parse_raw(struct_name, view.data(), view.size());
+}
+
+py::object StructParser::parse_raw(const std::string &struct_name,
+                                   const void *data, size_t size) {
+  auto it = struct_types_.find(struct_name);
+  if (it != struct_types_.end()) {
+    return it->second.attr("from_buffer_copy")(
+        py::bytes(static_cast<const char *>(data), size));
+  }
 
-  // Use ctypes.from_buffer_copy() to create struct from bytes
-  return struct_type.attr("from_buffer_copy")(data);
+  auto codec = get_codec(struct_name);
+  if (!codec) {
+    throw BpfException("Unknown struct: " + struct_name);
+  }
+  return codec->decode(data, size, format_);
 }
 
 bool StructParser::has_struct(const std::string &struct_name) const {
-  return struct_types_.find(struct_name) != struct_types_.end();
+  return struct_types_.find(struct_name) != struct_types_.end() ||
+         get_codec(struct_name) != nullptr;
+}
+
+void StructParser::prepare(const std::string &struct_name) const {
+  if (!has_struct(struct_name)) {
+    throw BpfException("Unknown struct: " + struct_name);
+  }
+}
+
+std::shared_ptr<BtfCodec>
+StructParser::get_codec(const std::string &struct_name) const {
+  if (struct_types_.find(struct_name) != struct_types_.end()) {
+    return nullptr;
+  }
+
+  auto it = codecs_.find(struct_name);
+  if (it != codecs_.end()) {
+    return it->second;
+  }
+
+  auto codec = BtfCodec::for_name(btf_, struct_name);
+  if (codec) {
+    codecs_[struct_name] = codec;
+  }
+  return codec;
 }
@@ -1,20 +1,52 @@
 #ifndef PYLIBBPF_STRUCT_PARSER_H
 #define PYLIBBPF_STRUCT_PARSER_H
 
+#include "utils/btf_codec.h"
+#include <memory>
 #include <pybind11/pybind11.h>
 #include <string>
 #include <unordered_map>
 
 namespace py = pybind11;
 
+/**
+ * StructParser - Turns raw event bytes into Python objects.
+ *
+ * User supplied ctypes classes take precedence; any other struct name is
+ * decoded natively from the object's BTF.
+ */
 class StructParser {
 private:
   std::unordered_map<std::string, py::object> struct_types_;
+  const struct btf *btf_;
+  StructFormat format_;
+  mutable std::unordered_map<std::string, std::shared_ptr<BtfCodec>> codecs_;
 
 public:
-  explicit StructParser(py::dict structs);
+  explicit StructParser(py::dict structs, const struct btf *btf = nullptr);
+
+  // BTF is owned by the bpf_object; cleared when the object is closed
+  void set_btf(const struct btf *btf) { btf_ = btf; }
+
+  void set_format(StructFormat format) { format_ = format; }
+  [[nodiscard]] StructFormat get_format() const { return format_; }
+
   py::object parse(const std::string &struct_name, py::bytes data);
+  py::object parse_raw(const std::string &struct_name, const void *data,
+                       size_t size);
   bool has_struct(const std::string &struct_name) const;
+
+  /**
+   * Compile a struct's BTF decode plan now (a no-op for ctypes structs and
+   * plans already compiled). Throws for unknown names.
+   */
+  void prepare(const std::string &struct_name) const;
+
+  /**
+   * BTF codec for a struct, compiled on first use.
+   * Returns nullptr for ctypes structs and unknown names.
+   */
+  std::shared_ptr<BtfCodec> get_codec(const std::string &struct_name) const;
 };
 
 #endif
@@ -0,0 +1,116 @@
+import os
+import struct
+
+import pytest
+
+import pylibbpf as m
+from pylibbpf import pylibbpf as _native
+
+# Native hooks, only built with -DPYLIBBPF_TESTING=ON
+_testing = getattr(_native, "_testing", None)
+
+requires_testing = pytest.mark.skipif(
+    _testing is None, reason="pylibbpf built without PYLIBBPF_TESTING"
+)
+requires_root = pytest.mark.skipif(
+    os.geteuid() != 0, reason="loading BPF objects needs root"
+)
+
+EXECVE_OBJ = "tests/execve2.o"
+EXECVE_PROGRAMS = ("hello", "hello_again")
+# Built from tests/kprobe.ll; "on_missing" probes a function that does not
+# exist, so its attach always fails
+KPROBE_OBJ = "tests/kprobe.o"
+LAST_MAP_SIZE = 64
+
+
+def load_object(configure=None, path=EXECVE_OBJ):
+    """Open, optionally configure, and load a test object; skip on failure."""
+    obj = m.BpfObject(path, structs={})
+    try:
+        obj.open()
+        if configure:
+            configure(obj)
+        obj.load()
+    except m.BpfException as exc:
+        pytest.skip(f"cannot load {path}: {exc}")
+    return obj
+
+
+# BPF_MAP_TYPE_* values used to reshape the test object's map
+HASH, ARRAY, PERF_EVENT_ARRAY, PERCPU_HASH, PERCPU_ARRAY = 1, 2, 4, 5, 6
+RINGBUF = 27
+PAGE_SIZE = os.sysconf("SC_PAGE_SIZE")
+
+
+def load_reshaped(map_type, key_size, value_size, max_entries):
+    """Load the execve object with its "last" map turned into another type.
+
+    The programs use "last" as a hash map, so they are left unloaded.
+    """
+    if _testing is None:
+        pytest.skip("pylibbpf built without PYLIBBPF_TESTING")
+
+    def configure(obj):
+        for name in EXECVE_PROGRAMS:
+            obj.set_autoload(name, False)
+        _testing.set_map_def(
+            obj._obj, "last", map_type, key_size, value_size, max_entries
+        )
+
+    return load_object(configure)
+
+
+@pytest.fixture
+def last_map():
+    """The execve object's u32 -> u64 hash map, with its object kept alive.
+
+    The object declares it with a single entry; room is made for the tests.
+    """
+    obj = load_object(lambda obj: obj.set_max_entries("last", LAST_MAP_SIZE))
+    yield obj.get_map("last")
+
+
+# struct inner { __u32 pid; int tgid; };
+# struct event {
+#     __u64 ts;
+#     int delta;
+#     __u32 flags : 3;
+#     int level : 5;
+#     char comm[8];
+#     struct inner task;
+# };
+EVENT_FORMAT = "<QiI8sIi"
+EVENT_SIZE = struct.calcsize(EVENT_FORMAT)
+
+
+def pack_event(ts=0, delta=0, flags=0, level=0, comm=b"", pid=0, tgid=0):
+    bits = (flags & 0x7) | ((level & 0x1F) << 3)
+    return struct.pack(EVENT_FORMAT, ts, delta, bits, comm, pid, tgid)
+
+
+@pytest.fixture
+def btf():
+    """In-memory BTF describing struct inner and struct event above."""
+    if _testing is None:
+        pytest.skip("pylibbpf built without PYLIBBPF_TESTING")
+    btf = _testing.Btf()
+    u64 = btf.add_int("unsigned long long", 8)
+    u32 = btf.add_int("unsigned int", 4)
+    s32 = btf.add_int("int", 4, signed=True)
+    char = btf.add_int("char", 1, char=True)
+    comm = btf.add_array(char, 8)
+    inner = btf.add_struct("inner", 8, [("pid", u32, 0), ("tgid", s32, 32)])
+    btf.add_struct(
+        "event",
+        EVENT_SIZE,
+        [
+            ("ts", u64, 0),
+            ("delta", s32, 64),
+            ("flags", u32, 96, 3),
+            ("level", s32, 99, 5),
+            ("comm", comm, 128),
+            ("task", inner, 192),
+        ],
+    )
+    return btf
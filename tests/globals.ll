@@ -0,0 +1,47 @@
+; Source of globals.o: typed .rodata/.bss globals for the lifecycle tests.
+; Rebuild with: llc -march=bpf -filetype=obj tests/globals.ll -o tests/globals.o
+
+@threshold = dso_local constant i32 7, section ".rodata", align 4, !dbg !0
+@hits = dso_local global i64 0, section ".bss", align 8, !dbg !2
+@LICENSE = dso_local global [4 x i8] c"GPL\00", section "license", align 1
+
+define dso_local i32 @probe(i8* %ctx) #0 section "kprobe/do_nanosleep"
+    !dbg !11 {
+  %1 = load volatile i32, i32* @threshold, align 4, !dbg !14
+  ret i32 %1, !dbg !14
+}
+
+attributes #0 = { nounwind }
+
+!llvm.dbg.cu = !{!4}
+!llvm.module.flags = !{!17, !18}
+
+; const volatile unsigned int threshold = 7;
+!0 = !DIGlobalVariableExpression(var: !1, expr: !DIExpression())
+!1 = distinct !DIGlobalVariable(name: "threshold", scope: !4, file: !5,
+                                line: 1, type: !8, isLocal: false,
+                                isDefinition: true)
+; unsigned long long hits;
+!2 = !DIGlobalVariableExpression(var: !3, expr: !DIExpression())
+!3 = distinct !DIGlobalVariable(name: "hits", scope: !4, file: !5, line: 2,
+                                type: !10, isLocal: false, isDefinition: true)
+!4 = distinct !DICompileUnit(language: DW_LANG_C99, file: !5,
+                             emissionKind: FullDebug, globals: !6)
+!5 = !DIFile(filename: "globals.c", directory: "/")
+!6 = !{!0, !2}
+!7 = !DIBasicType(name: "unsigned int", size: 32, encoding: DW_ATE_unsigned)
+!8 = !DIDerivedType(tag: DW_TAG_const_type, baseType: !9)
+!9 = !DIDerivedType(tag: DW_TAG_volatile_type, baseType: !7)
+!10 = !DIBasicType(name: "unsigned long long", size: 64,
+                   encoding: DW_ATE_unsigned)
+; int probe(void *ctx) { return threshold; }
+!11 = distinct !DISubprogram(name: "probe", scope: !5, file: !5, line: 4,
+                             type: !12, scopeLine: 4,
+                             spFlags: DISPFlagDefinition, unit: !4)
+!12 = !DISubroutineType(types: !13)
+!13 = !{!15, !16}
+!14 = !DILocation(line: 5, scope: !11)
+!15 = !DIBasicType(name: "int", size: 32, encoding: DW_ATE_signed)
+!16 = !DIDerivedType(tag: DW_TAG_pointer_type, baseType: null, size: 64)
+!17 = !{i32 7, !"Dwarf Version", i32 5}
+!18 = !{i32 2, !"Debug Info Version", i32 3}
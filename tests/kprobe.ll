@@ -0,0 +1,15 @@
+; Source of kprobe.o: two plain kprobes for the multi-attach tests.
+; Rebuild with: llc -march=bpf -filetype=obj tests/kprobe.ll -o tests/kprobe.o
+
+@LICENSE = dso_local global [4 x i8] c"GPL\00", section "license", align 1
+
+define dso_local i32 @on_nanosleep(i8* %ctx) #0 section "kprobe/do_nanosleep" {
+  ret i32 0
+}
+
+define dso_local i32 @on_missing(i8* %ctx) #0
+    section "kprobe/pylibbpf_no_such_function" {
+  ret i32 0
+}
+
+attributes #0 = { nounwind }
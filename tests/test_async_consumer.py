@@ -0,0 +1,66 @@
+import asyncio
+
+import pytest
+from conftest import (
+    PAGE_SIZE,
+    PERF_EVENT_ARRAY,
+    RINGBUF,
+    load_reshaped,
+    requires_root,
+    requires_testing,
+)
+
+from pylibbpf.wrappers import PerfEventArrayHelper, RingBufferHelper
+
+
+@pytest.mark.parametrize("helper", [PerfEventArrayHelper, RingBufferHelper])
+def test_requires_open_consumer(helper):
+    with pytest.raises(RuntimeError):
+        helper(None).fileno()
+    with pytest.raises(RuntimeError):
+        _ = helper(None).source
+
+
+@pytest.fixture(params=["perf", "ring"])
+def consumer(request):
+    """An opened helper over a map no program writes to."""
+    if request.param == "perf":
+        obj = load_reshaped(PERF_EVENT_ARRAY, 4, 4, 0)
+        yield obj["last"].open_perf_buffer(lambda cpu, data: None, page_cnt=1)
+    else:
+        obj = load_reshaped(RINGBUF, 0, 0, 4 * PAGE_SIZE)
+        yield obj["last"].open_ring_buffer(lambda data: None)
+
+
+@requires_root
+@requires_testing
+def test_fileno_is_epoll_fd(consumer):
+    assert consumer.fileno() == consumer.source.epoll_fd() >= 0
+
+
+@requires_root
+@requires_testing
+def test_add_and_remove_reader(consumer):
+    async def run():
+        loop = asyncio.get_running_loop()
+        assert consumer.add_reader() is consumer
+        assert consumer.remove_reader() is consumer
+        # Nothing is left registered for the fd
+        assert not loop.remove_reader(consumer.fileno())
+
+    asyncio.run(run())
+
+
+@requires_root
+@requires_testing
+def test_stream_waits_and_cleans_up(consumer):
+    async def run():
+        loop = asyncio.get_running_loop()
+        stream = consumer.stream()
+        # No program produces events, so the stream never becomes ready
+        with pytest.raises(asyncio.TimeoutError):
+            await asyncio.wait_for(stream.__anext__(), 0.05)
+        await stream.aclose()
+        assert not loop.remove_reader(consumer.fileno())
+
+    asyncio.run(run())
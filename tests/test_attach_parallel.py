@@ -0,0 +1,59 @@
+import pytest
+from conftest import EXECVE_PROGRAMS, KPROBE_OBJ, load_object, requires_root
+
+import pylibbpf as m
+
+pytestmark = requires_root
+
+
+def multi_attach(obj):
+    obj.set_multi_attach(True)
+
+
+def test_attach_all_parallel():
+    obj = load_object()
+    report = obj.attach_all_parallel(max_threads=2)
+    assert sorted(report) == sorted(EXECVE_PROGRAMS)
+    for entry in report.values():
+        assert entry["ok"]
+        assert entry["error"] is None
+        assert entry["method"] == "bpf_program__attach"
+        assert entry["elapsed_us"] >= 0
+    assert all(obj.get_program(name).is_attached() for name in EXECVE_PROGRAMS)
+
+    # Programs that are already attached are skipped
+    assert obj.attach_all_parallel() == {}
+
+
+def test_multi_attach_leaves_tracepoints_alone():
+    obj = load_object(multi_attach)
+    report = obj.attach_all_parallel()
+    assert {entry["method"] for entry in report.values()} == {
+        "bpf_program__attach"
+    }
+    assert all(entry["ok"] for entry in report.values())
+
+
+def test_set_multi_attach_after_load():
+    obj = load_object()
+    with pytest.raises(m.BpfException):
+        obj.set_multi_attach(True)
+
+
+def test_plain_kprobes():
+    report = load_object(path=KPROBE_OBJ).attach_all_parallel()
+    assert report["on_nanosleep"]["ok"]
+    assert report["on_nanosleep"]["method"] == "bpf_program__attach"
+    assert not report["on_missing"]["ok"]
+    assert report["on_missing"]["method"] == "bpf_program__attach"
+
+
+def test_multi_kprobes_report_multi_link_errors():
+    # Kernels without kprobe_multi reject the program at load and skip here
+    report = load_object(multi_attach, path=KPROBE_OBJ).attach_all_parallel()
+    assert report["on_nanosleep"]["ok"]
+    assert report["on_nanosleep"]["method"] == "kprobe_multi"
+    # No perf-event fallback: the multi link's own error is reported
+    assert not report["on_missing"]["ok"]
+    assert report["on_missing"]["method"] == "kprobe_multi"
+    assert report["on_missing"]["error"]
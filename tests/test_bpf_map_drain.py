@@ -0,0 +1,72 @@
+import threading
+
+import pytest
+from conftest import (
+    ARRAY,
+    _testing,
+    load_reshaped,
+    requires_root,
+    requires_testing,
+)
+
+import pylibbpf as m
+
+pytestmark = requires_root
+
+
+def unpack(entry):
+    key, value = entry
+    return int.from_bytes(key, "little"), int.from_bytes(value, "little")
+
+
+@pytest.mark.parametrize("chunk", [1, 4, 256])
+def test_drain_empties_map(last_map, chunk):
+    for key in range(10):
+        last_map[key] = key + 100
+    assert last_map.drain(chunk) == {key: key + 100 for key in range(10)}
+    assert last_map.items() == {}
+    assert last_map.drain() == {}
+
+
+def test_drain_rejects_empty_chunks(last_map):
+    with pytest.raises(m.BpfException, match="chunk_size"):
+        last_map.drain(0)
+
+
+@requires_testing
+def test_drain_rejects_arrays():
+    obj = load_reshaped(ARRAY, 4, 8, 4)
+    array = obj.get_map("last")
+    with pytest.raises(m.BpfException, match="draining"):
+        array.drain()
+
+
+@requires_testing
+@pytest.mark.parametrize("chunk", [1, 3, 16])
+def test_per_key_drain(last_map, chunk):
+    for key in range(10):
+        last_map[key] = key * 2
+    drained = _testing.dump_per_key(last_map, chunk, drain=True)
+    assert sorted(unpack(e) for e in drained) == [(k, k * 2) for k in range(10)]
+    assert last_map.items() == {}
+
+
+@requires_testing
+def test_per_key_drain_ends_under_inserts(last_map):
+    limit = last_map.get_max_entries()
+    stop = threading.Event()
+
+    def insert():
+        key = 0
+        while not stop.is_set():
+            last_map[key % limit] = key
+            key += 1
+
+    thread = threading.Thread(target=insert)
+    thread.start()
+    try:
+        drained = _testing.dump_per_key(last_map, 8, drain=True)
+    finally:
+        stop.set()
+        thread.join()
+    assert len(drained) <= limit
@@ -0,0 +1,45 @@
+import pytest
+from conftest import _testing, requires_root, requires_testing
+
+import pylibbpf as m
+
+
+def unpack(entry):
+    key, value = entry
+    return int.from_bytes(key, "little"), int.from_bytes(value, "little")
+
+
+def fill(bpf_map):
+    for key in (42, 69, 31):
+        bpf_map[key] = key * 10
+
+
+@requires_root
+@pytest.mark.parametrize("chunk", [1, 2, 8])
+def test_batched_dump(last_map, chunk):
+    fill(last_map)
+    assert last_map.items(chunk) == {31: 310, 42: 420, 69: 690}
+    assert sorted(last_map.keys(chunk)) == [31, 42, 69]
+    assert sorted(last_map.values(chunk)) == [310, 420, 690]
+
+
+@requires_root
+def test_batched_dump_rejects_empty_chunks(last_map):
+    with pytest.raises(m.BpfException, match="chunk_size"):
+        last_map.items(0)
+
+
+@requires_root
+@requires_testing
+@pytest.mark.parametrize("chunk", [1, 2, 8])
+def test_per_key_fallback_matches_items(last_map, chunk):
+    fill(last_map)
+    dumped = sorted(unpack(e) for e in _testing.dump_per_key(last_map, chunk))
+    assert dumped == [(31, 310), (42, 420), (69, 690)]
+    assert dumped == sorted(last_map.items().items())
+
+
+@requires_root
+@requires_testing
+def test_per_key_fallback_on_empty_map(last_map):
+    assert _testing.dump_per_key(last_map) == []
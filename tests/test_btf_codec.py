@@ -0,0 +1,111 @@
+import pytest
+from conftest import EXECVE_OBJ, pack_event, requires_root
+
+import pylibbpf as m
+
+
+def test_decode_bitfields_and_char_array(btf):
+    data = pack_event(ts=7, delta=-2, flags=5, level=-3, comm=b"bash", pid=42)
+    event = btf.decode("event", data)
+    assert event["ts"] == 7
+    assert event["delta"] == -2
+    assert event["flags"] == 5
+    assert event["level"] == -3
+    assert event["comm"] == b"bash"
+    assert event["task"]["pid"] == 42
+
+
+def test_decode_char_array_as_text(btf):
+    event = btf.decode("event", pack_event(comm=b"sh"), text=True)
+    assert event["comm"] == "sh"
+
+
+def test_decode_full_width_char_array(btf):
+    event = btf.decode("event", pack_event(comm=b"12345678"))
+    assert event["comm"] == b"12345678"
+
+
+def test_decode_formats(btf):
+    data = pack_event(ts=1, pid=2)
+    named = btf.decode("event", data, format=m.StructFormat.NAMEDTUPLE)
+    assert named.ts == 1
+    assert named.task.pid == 2
+    plain = btf.decode("event", data, format=m.StructFormat.TUPLE)
+    assert plain[0] == 1
+    assert plain[-1] == (2, 0)
+
+
+def test_struct_parser_decodes_from_btf(btf):
+    parser = btf.parser()
+    assert parser.has_struct("event")
+    assert not parser.has_struct("missing")
+    event = parser.parse("event", pack_event(ts=3, comm=b"cat"))
+    assert (event.ts, event.comm) == (3, b"cat")
+
+
+def test_encode_round_trip(btf):
+    data = pack_event(ts=9, delta=-1, flags=7, level=-16, comm=b"cat", tgid=-5)
+    assert btf.encode("event", btf.decode("event", data)) == data
+    text = btf.decode("event", data, text=True)
+    assert btf.encode("event", text) == data
+
+
+def test_encode_zero_fills_missing_fields(btf):
+    assert btf.encode("event", {"ts": 3}) == pack_event(ts=3)
+
+
+def test_encode_accepts_full_ranges(btf):
+    fields = {"ts": 2**64 - 1, "delta": -(2**31), "flags": 7, "level": 15}
+    assert btf.decode("event", btf.encode("event", fields))["ts"] == 2**64 - 1
+
+
+@pytest.mark.parametrize(
+    "fields",
+    [
+        {"flags": 8},
+        {"level": 16},
+        {"level": -17},
+        {"delta": 2**31},
+        {"ts": -1},
+        {"ts": 2**64},
+        {"task": {"tgid": -(2**31) - 1}},
+        {"comm": "12345678"},
+    ],
+)
+def test_encode_range_checks(btf, fields):
+    with pytest.raises(m.BpfException):
+        btf.encode("event", fields)
+
+
+def test_encode_rejects_wrong_type(btf):
+    with pytest.raises(m.BpfException):
+        btf.encode("event", {"ts": "soon"})
+
+
+def test_unknown_struct(btf):
+    with pytest.raises(m.BpfException):
+        btf.decode("missing", b"")
+
+
+def test_load_rejects_unknown_decode_structs():
+    obj = m.BpfObject(EXECVE_OBJ, structs={})
+    obj.open()
+    obj.set_decode_structs(["no_such_struct"])
+    with pytest.raises(m.BpfException, match="no_such_struct"):
+        obj.load()
+    assert not obj.is_loaded()
+
+
+def test_decode_structs_needs_an_open_object():
+    with pytest.raises(m.BpfException):
+        m.BpfObject(EXECVE_OBJ, structs={}).set_decode_structs(["event"])
+
+
+@requires_root
+def test_map_keys_and_values_use_btf_types(last_map):
+    if not (last_map.has_btf_key() and last_map.has_btf_value()):
+        pytest.skip("map has no BTF key/value types")
+    last_map[7] = 2**64 - 1
+    assert last_map[7] == 2**64 - 1
+    with pytest.raises(m.BpfException):
+        last_map[8] = -1
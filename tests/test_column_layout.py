@@ -0,0 +1,22 @@
+def test_nested_structs_flatten_to_dotted_names(btf):
+    assert btf.columns("event") == [
+        "ts",
+        "delta",
+        "flags",
+        "level",
+        "comm",
+        "task.pid",
+        "task.tgid",
+    ]
+
+
+def test_inner_struct_keeps_plain_names(btf):
+    assert btf.columns("inner") == ["pid", "tgid"]
+
+
+def test_deeper_nesting_joins_every_level(btf):
+    u32 = btf.add_int("u32", 4)
+    inner = btf.add_struct("leaf", 4, [("pid", u32, 0)])
+    middle = btf.add_struct("middle", 4, [("task", inner, 0)])
+    btf.add_struct("outer", 8, [("id", u32, 0), ("ctx", middle, 32)])
+    assert btf.columns("outer") == ["id", "ctx.task.pid"]
@@ -0,0 +1,77 @@
+import pytest
+from conftest import (
+    PERF_EVENT_ARRAY,
+    _testing,
+    load_reshaped,
+    requires_root,
+    requires_testing,
+)
+
+import pylibbpf as m
+
+
+@requires_testing
+def test_per_cpu_counters():
+    stats = _testing.ConsumerStats(2)
+    stats.record_sample(0, 16)
+    stats.record_sample(1, 32)
+    stats.record_sample(1, 8)
+    stats.record_lost(1, 5)
+    # Out-of-range CPUs are folded into the last slot
+    stats.record_sample(7, 4)
+
+    snapshot = stats.snapshot()
+    assert (snapshot["samples"], snapshot["bytes"], snapshot["lost"]) == (4, 60, 5)
+    assert snapshot["per_cpu"] == [
+        {"samples": 1, "bytes": 16, "lost": 0},
+        {"samples": 3, "bytes": 44, "lost": 5},
+    ]
+
+
+@requires_testing
+def test_timings_and_histogram():
+    stats = _testing.ConsumerStats(1)
+    stats.record_poll(100)
+    stats.record_poll(50)
+    stats.record_decode(7)
+    stats.record_callback(3, 0)
+    stats.record_callback(4, 1000)
+    stats.record_callback(5, 1023)
+
+    snapshot = stats.snapshot()
+    assert (snapshot["polls"], snapshot["poll_ns"]) == (2, 150)
+    assert snapshot["decode_ns"] == 7
+    assert snapshot["gil_wait_ns"] == 12
+    assert (snapshot["callbacks"], snapshot["callback_ns"]) == (3, 2023)
+    assert snapshot["callback_latency_ns"] == [(0, 2, 1), (512, 1024, 2)]
+
+
+@requires_testing
+def test_reset():
+    stats = _testing.ConsumerStats(1)
+    stats.record_sample(0, 1)
+    stats.record_callback(1, 1)
+    stats.reset()
+    snapshot = stats.snapshot()
+    assert snapshot["samples"] == snapshot["callbacks"] == 0
+    assert snapshot["callback_latency_ns"] == []
+
+
+@pytest.fixture
+def perf_map():
+    obj = load_reshaped(PERF_EVENT_ARRAY, 4, 4, 0)
+    yield obj.get_map("last")
+
+
+@requires_root
+@requires_testing
+def test_perf_event_array_counts_polls(perf_map):
+    perf = m.PerfEventArray(perf_map, 1, lambda cpu, data: None)
+    assert perf.stats()["polls"] == 0
+    assert perf.poll(0) == 0
+    assert perf.consume() == 0
+    stats = perf.stats()
+    assert stats["polls"] == 2
+    assert stats["samples"] == stats["lost"] == 0
+    perf.reset_stats()
+    assert perf.stats()["polls"] == 0
@@ -0,0 +1,109 @@
+import time
+
+import pytest
+from conftest import _testing, pack_event, requires_testing
+
+import pylibbpf as m
+
+pytestmark = requires_testing
+
+
+@pytest.mark.parametrize(
+    ("op", "value", "expected"),
+    [
+        ("==", 42, True),
+        ("!=", 42, False),
+        ("<", 43, True),
+        ("<=", 41, False),
+        (">", 41, True),
+        (">=", 43, False),
+        ("in", [1, 42], True),
+        ("not in", [1, 42], False),
+    ],
+)
+def test_integer_comparisons(btf, op, value, expected):
+    flt = m.EventFilter().where("task.pid", op, value)
+    assert btf.admit(flt, "event", pack_event(pid=42)) is expected
+
+
+def test_signed_and_bitfield_fields(btf):
+    flt = m.EventFilter().where("level", "<", 0).where("flags", "==", 5)
+    assert btf.admit(flt, "event", pack_event(flags=5, level=-1))
+    assert not btf.admit(flt, "event", pack_event(flags=5, level=1))
+    assert not btf.admit(flt, "event", pack_event(flags=4, level=-1))
+
+
+def test_string_fields(btf):
+    flt = m.EventFilter().where("comm", "in", ["bash", b"sh"])
+    assert btf.admit(flt, "event", pack_event(comm=b"sh"))
+    assert btf.admit(flt, "event", pack_event(comm=b"bash"))
+    assert not btf.admit(flt, "event", pack_event(comm=b"zsh"))
+
+    with pytest.raises(m.BpfException):
+        btf.admit(m.EventFilter().where("comm", "<", "a"), "event", b"")
+
+
+def test_short_samples_do_not_match(btf):
+    flt = m.EventFilter().where("task.tgid", "==", 0)
+    assert not btf.admit(flt, "event", pack_event()[:-1])
+    assert flt.get_stats()["filtered"] == 1
+
+
+def test_unknown_field(btf):
+    flt = m.EventFilter().where("nope", "==", 1)
+    with pytest.raises(m.BpfException):
+        btf.admit(flt, "event", pack_event())
+
+
+def test_sampling_keeps_one_in_n():
+    flt = m.EventFilter().sample(3)
+    admitted = [_testing.admit_raw(flt, b"x") for _ in range(9)]
+    assert admitted == [True, False, False] * 3
+    stats = flt.get_stats()
+    assert stats["passed"] == 3
+    assert stats["sampled_out"] == 6
+
+    with pytest.raises(m.BpfException):
+        flt.sample(0)
+
+
+def test_rate_limit_allows_a_burst():
+    flt = m.EventFilter().rate_limit(0.001, burst=5)
+    admitted = sum(_testing.admit_raw(flt, b"x") for _ in range(10))
+    assert admitted == 5
+    assert flt.get_stats()["rate_limited"] == 5
+
+
+def test_slow_rate_limit_admits_first_event():
+    flt = m.EventFilter().rate_limit(0.5)
+    assert _testing.admit_raw(flt, b"x")
+    assert not _testing.admit_raw(flt, b"x")
+
+
+def test_rate_limit_counts_whole_events_of_a_fractional_burst():
+    flt = m.EventFilter().rate_limit(0.001, burst=2.5)
+    assert sum(_testing.admit_raw(flt, b"x") for _ in range(5)) == 2
+
+
+def test_rate_limit_refills_over_time():
+    flt = m.EventFilter().rate_limit(50, burst=1)
+    assert _testing.admit_raw(flt, b"x")
+    assert not _testing.admit_raw(flt, b"x")
+    time.sleep(0.1)
+    assert _testing.admit_raw(flt, b"x")
+
+
+def test_rate_limit_reset_refills_the_bucket():
+    flt = m.EventFilter().rate_limit(0.001, burst=1)
+    assert _testing.admit_raw(flt, b"x")
+    assert not _testing.admit_raw(flt, b"x")
+    flt.rate_limit(0.001, burst=1)
+    assert _testing.admit_raw(flt, b"x")
+    flt.rate_limit(0)
+    assert all(_testing.admit_raw(flt, b"x") for _ in range(100))
+
+
+@pytest.mark.parametrize(("rate", "burst"), [(-1, 0), (10, -1), (10, 0.5)])
+def test_rate_limit_rejects_bad_values(rate, burst):
+    with pytest.raises(m.BpfException):
+        m.EventFilter().rate_limit(rate, burst)
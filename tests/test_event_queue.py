@@ -0,0 +1,85 @@
+import threading
+import time
+
+from conftest import _testing, requires_testing
+
+import pylibbpf as m
+
+pytestmark = requires_testing
+
+
+def drain(queue):
+    events = []
+    while (event := queue.pop()) is not None:
+        events.append(event)
+    return events
+
+
+def test_capacity_rounds_up_to_power_of_two():
+    assert _testing.EventQueue(3, m.OverflowPolicy.DROP_NEWEST).capacity == 4
+
+
+def test_drop_newest_rejects_when_full():
+    queue = _testing.EventQueue(4, m.OverflowPolicy.DROP_NEWEST)
+    assert all(queue.push(0, bytes([i])) for i in range(4))
+    assert not queue.push(1, b"\x04")
+    assert drain(queue) == [(0, bytes([i])) for i in range(4)]
+    stats = queue.get_stats()
+    assert stats["enqueued"] == 4
+    assert stats["dropped_newest"] == 1
+
+
+def test_drop_oldest_evicts_head():
+    queue = _testing.EventQueue(4, m.OverflowPolicy.DROP_OLDEST)
+    assert all(queue.push(0, bytes([i])) for i in range(6))
+    assert [data for _, data in drain(queue)] == [bytes([i]) for i in range(2, 6)]
+    stats = queue.get_stats()
+    assert stats["enqueued"] == 6
+    assert stats["dropped_oldest"] == 2
+
+
+def test_block_waits_for_room():
+    queue = _testing.EventQueue(2, m.OverflowPolicy.BLOCK)
+    queue.push(0, b"a")
+    queue.push(0, b"b")
+
+    result = []
+    producer = threading.Thread(target=lambda: result.append(queue.push(0, b"c")))
+    producer.start()
+    time.sleep(0.1)
+    assert producer.is_alive()
+
+    assert queue.pop() == (0, b"a")
+    producer.join(timeout=5)
+    assert result == [True]
+    assert [data for _, data in drain(queue)] == [b"b", b"c"]
+    assert queue.get_stats()["blocked"] == 1
+
+
+def test_close_releases_blocked_producer():
+    queue = _testing.EventQueue(1, m.OverflowPolicy.BLOCK)
+    queue.push(0, b"a")
+
+    result = []
+    producer = threading.Thread(target=lambda: result.append(queue.push(0, b"b")))
+    producer.start()
+    time.sleep(0.05)
+    queue.close()
+    producer.join(timeout=5)
+    assert result == [False]
+    assert queue.get_stats()["dropped_newest"] == 1
+
+
+def test_samples_larger_than_a_slot_spill():
+    queue = _testing.EventQueue(2, m.OverflowPolicy.DROP_OLDEST, slot_size=8)
+    assert queue.slot_size == 8
+    small, large = b"s" * 8, bytes(range(200))
+    for _ in range(3):
+        queue.push(0, large)
+        queue.push(1, small)
+        assert drain(queue) == [(0, large), (1, small)]
+
+
+def test_pop_times_out_when_empty():
+    queue = _testing.EventQueue(2, m.OverflowPolicy.DROP_NEWEST)
+    assert queue.pop(timeout_ms=10) is None
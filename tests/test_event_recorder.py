@@ -0,0 +1,90 @@
+import pytest
+from conftest import _testing, pack_event, requires_testing
+
+import pylibbpf as m
+
+
+@requires_testing
+def test_round_trip(tmp_path):
+    path = str(tmp_path / "capture")
+    recorder = m.EventRecorder(path)
+    for cpu in range(4):
+        _testing.record(recorder, cpu, bytes([cpu]) * (cpu + 1))
+    recorder.close()
+    assert recorder.get_stats()["records"] == 4
+
+    replay = m.EventReplay(path)
+    events = replay.read()
+    assert [(cpu, data) for cpu, _, data in events] == [
+        (cpu, bytes([cpu]) * (cpu + 1)) for cpu in range(4)
+    ]
+    timestamps = [ts for _, ts, _ in events]
+    assert timestamps == sorted(timestamps)
+
+    seen = []
+    assert replay.replay(lambda cpu, data: seen.append((cpu, data))) == 4
+    assert seen == [(cpu, data) for cpu, _, data in events]
+    assert len(replay.read(max_events=2)) == 2
+
+
+@requires_testing
+def test_round_trip_across_segments(tmp_path):
+    path = str(tmp_path / "capture")
+    recorder = m.EventRecorder(path, segment_size=64, buffer_size=32)
+    for i in range(32):
+        _testing.record(recorder, 0, i.to_bytes(4, "little"))
+    recorder.close()
+
+    replay = m.EventReplay(path)
+    assert replay.get_num_segments() > 1
+    assert [data for _, _, data in replay.read()] == [
+        i.to_bytes(4, "little") for i in range(32)
+    ]
+
+
+@requires_testing
+def test_replay_decodes_structs(btf, tmp_path):
+    path = str(tmp_path / "capture")
+    recorder = m.EventRecorder(path)
+    _testing.record(recorder, 1, pack_event(ts=5, comm=b"bash", pid=9))
+    recorder.close()
+
+    parser = btf.parser()
+    parser.format = m.StructFormat.DICT
+    seen = []
+    m.EventReplay(path).replay(
+        lambda cpu, event: seen.append((cpu, event)), "event", parser
+    )
+    assert len(seen) == 1
+    cpu, event = seen[0]
+    assert cpu == 1
+    assert (event["ts"], event["comm"], event["task"]["pid"]) == (5, b"bash", 9)
+
+
+@requires_testing
+def test_replay_rejects_unknown_struct(btf, tmp_path):
+    path = str(tmp_path / "capture")
+    recorder = m.EventRecorder(path)
+    _testing.record(recorder, 0, b"x")
+    recorder.close()
+
+    with pytest.raises(m.BpfException):
+        m.EventReplay(path).replay(lambda cpu, event: None, "missing", btf.parser())
+
+
+def test_empty_recording(tmp_path):
+    path = str(tmp_path / "capture")
+    recorder = m.EventRecorder(path)
+    recorder.close()
+    assert recorder.get_stats()["records"] == 0
+    assert m.EventReplay(path).read() == []
+
+
+def test_segment_must_hold_the_buffer(tmp_path):
+    with pytest.raises(m.BpfException):
+        m.EventRecorder(str(tmp_path / "capture"), segment_size=16, buffer_size=32)
+
+
+def test_missing_recording(tmp_path):
+    with pytest.raises(m.BpfException):
+        m.EventReplay(str(tmp_path / "nothing"))
@@ -0,0 +1,99 @@
+import ctypes
+
+import pytest
+from conftest import _testing, pack_event, requires_testing
+
+import pylibbpf as m
+
+pytestmark = requires_testing
+
+SAMPLE = bytes(range(32))
+
+
+class Pair(ctypes.Structure):
+    _fields_ = [("a", ctypes.c_uint32), ("b", ctypes.c_uint32)]
+
+
+@pytest.fixture
+def sample():
+    sample = _testing.Sample()
+    yield sample
+    sample.release()
+
+
+def test_memoryview_is_read_only(sample):
+    view = sample.view(SAMPLE)
+    mv = view.memoryview()
+    assert mv.readonly
+    assert mv.tobytes() == SAMPLE
+    assert len(view) == len(SAMPLE)
+    with pytest.raises(TypeError):
+        mv[0] = 1
+
+
+def test_released_view_raises(sample):
+    view = sample.view(SAMPLE)
+    sample.release()
+    assert not view.is_valid()
+    with pytest.raises(m.BpfException):
+        view.tobytes()
+    with pytest.raises(m.BpfException):
+        view.memoryview()
+
+
+def test_kept_memoryview_survives_release(sample):
+    view = sample.view(SAMPLE)
+    mv = view.memoryview()
+    sample.release()
+    assert mv.tobytes() == SAMPLE
+
+
+def test_kept_slice_survives_release(sample):
+    view = sample.view(SAMPLE)
+    head = view.memoryview()[:16]
+    sample.release()
+    assert head.tobytes() == SAMPLE[:16]
+
+
+def test_kept_buffer_is_not_reused(sample):
+    buffer = sample.view(SAMPLE).memoryview().obj
+    sample.release()
+    sample.view(bytes(32)).memoryview()
+    assert bytes(buffer) == SAMPLE
+
+
+def test_idle_buffer_is_reused(sample):
+    first = id(sample.view(SAMPLE).memoryview().obj)
+    sample.release()
+    mv = sample.view(bytes(8)).memoryview()
+    assert id(mv.obj) == first
+    assert mv.tobytes() == bytes(8)
+
+
+def test_btf_struct_survives_release(btf, sample):
+    data = pack_event(ts=7, comm=b"bash", pid=42)
+    view = sample.view(data, btf.parser(), "event")
+    event = view.as_struct()
+    assert view.ts == 7
+    sample.release()
+    assert event.ts == 7
+    assert event.task.pid == 42
+
+
+def test_ctypes_struct_is_a_copy(sample):
+    parser = m.StructParser({"pair": Pair})
+    view = sample.view(bytes([1, 0, 0, 0, 2, 0, 0, 0]), parser, "pair")
+    pair = view.as_struct()
+    pair.a = 5
+    assert view.tobytes()[0] == 1
+    sample.release()
+    assert (pair.a, pair.b) == (5, 2)
+
+
+def test_copy_without_struct(sample):
+    view = sample.view(SAMPLE)
+    assert view.copy() == SAMPLE
+    with pytest.raises(m.BpfException):
+        view.as_struct()
+    with pytest.raises(AttributeError):
+        _ = view.ts
@@ -0,0 +1,92 @@
+import os
+import uuid
+
+import pytest
+from conftest import KPROBE_OBJ, load_object, requires_root
+
+import pylibbpf as m
+
+BPFFS = "/sys/fs/bpf"
+
+pytestmark = [
+    requires_root,
+    pytest.mark.skipif(not os.path.ismount(BPFFS), reason="bpffs not mounted"),
+]
+
+
+@pytest.fixture
+def pin_path():
+    path = os.path.join(BPFFS, f"pylibbpf_test_{uuid.uuid4().hex}")
+    yield path
+    if os.path.exists(path):
+        os.unlink(path)
+
+
+@pytest.fixture
+def pinned(pin_path):
+    """A pinned "hello" link whose original handle has been dropped."""
+    obj = load_object()
+    prog = obj.get_program("hello")
+    prog.attach()
+    prog.pin_link(pin_path)
+    assert prog.is_link_pinned()
+    prog.detach()
+    return pin_path
+
+
+def test_detach_keeps_pinned_link(pinned):
+    assert os.path.exists(pinned)
+
+
+def test_adopt_and_unpin(pinned):
+    obj = load_object()
+    prog = obj.get_program("hello")
+    prog.adopt_link(pinned)
+    assert prog.is_attached()
+    assert prog.is_link_pinned()
+    with pytest.raises(m.BpfException, match="already attached"):
+        prog.adopt_link(pinned)
+
+    prog.unpin_link()
+    assert not os.path.exists(pinned)
+    with pytest.raises(m.BpfException, match="no pinned link"):
+        prog.unpin_link()
+
+
+def test_adopt_with_replace(pinned):
+    obj = load_object()
+    prog = obj.get_program("hello")
+    try:
+        prog.adopt_link(pinned, replace=True)
+    except m.BpfException as exc:
+        # Perf-event links cannot swap programs on most kernels; the old
+        # program must then keep running behind the pin
+        assert "Failed to replace" in str(exc)
+        assert not prog.is_attached()
+        assert os.path.exists(pinned)
+    else:
+        assert prog.is_attached()
+
+
+def test_adopt_rejects_other_program(pinned):
+    obj = load_object()
+    prog = obj.get_program("hello_again")
+    with pytest.raises(m.BpfException, match="does not match"):
+        prog.adopt_link(pinned)
+    assert not prog.is_attached()
+    # The refused link stays pinned for its owner
+    assert os.path.exists(pinned)
+
+
+def test_adopt_rejects_other_program_type(pinned):
+    obj = load_object(path=KPROBE_OBJ)
+    prog = obj.get_program("on_nanosleep")
+    with pytest.raises(m.BpfException, match="type"):
+        prog.adopt_link(pinned)
+
+
+def test_adopt_missing_path(pin_path):
+    obj = load_object()
+    prog = obj.get_program("hello")
+    with pytest.raises(m.BpfException, match="Failed to open pinned link"):
+        prog.adopt_link(pin_path)
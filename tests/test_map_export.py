@@ -0,0 +1,66 @@
+from array import array
+
+import pytest
+from conftest import PERCPU_HASH, load_reshaped, requires_root, requires_testing
+
+import pylibbpf as m
+
+pytestmark = requires_root
+
+
+@pytest.mark.parametrize("chunk", [1, 2, 256])
+def test_export_buffers(last_map, chunk):
+    for key in (3, 1, 2):
+        last_map[key] = key * 100
+    keys, values = last_map.export_buffers(chunk)
+    assert isinstance(keys, m.MapBuffer)
+    assert len(keys) == len(values) == 3
+    assert (keys.format, values.format) == ("I", "Q")
+    # Sized to what was dumped, not to max_entries
+    assert (keys.nbytes, values.nbytes) == (3 * 4, 3 * 8)
+
+    entries = zip(memoryview(keys).tolist(), memoryview(values).tolist())
+    assert sorted(entries) == [(1, 100), (2, 200), (3, 300)]
+
+
+def test_export_empty_map(last_map):
+    keys, values = last_map.export_buffers()
+    assert len(keys) == len(values) == 0
+    assert memoryview(values).tolist() == []
+
+
+def test_export_rejects_empty_chunks(last_map):
+    with pytest.raises(m.BpfException, match="chunk_size"):
+        last_map.export_buffers(0)
+
+
+def test_update_and_lookup_many(last_map):
+    last_map.update_many(array("I", [1, 2, 3]), array("Q", [10, 20, 30]))
+    assert last_map.items() == {1: 10, 2: 20, 3: 30}
+
+    values, found = last_map.lookup_many(array("I", [2, 9, 3]))
+    assert memoryview(found).tolist() == [True, False, True]
+    assert memoryview(values).tolist()[0] == 20
+    assert memoryview(values).tolist()[2] == 30
+
+
+def test_many_rejects_mismatched_buffers(last_map):
+    with pytest.raises(m.BpfException, match="same length"):
+        last_map.update_many(array("I", [1, 2]), array("Q", [1]))
+    with pytest.raises(m.BpfException, match="multiple of"):
+        last_map.lookup_many(b"\x00" * 6)
+
+
+@requires_testing
+def test_export_percpu_values():
+    obj = load_reshaped(PERCPU_HASH, 4, 8, 8)
+    percpu_map = obj.get_map("last")
+    cpus = percpu_map.get_num_cpus()
+    percpu_map[1] = list(range(cpus))
+    percpu_map[2] = 5
+
+    keys, values = percpu_map.export_buffers()
+    view = memoryview(values)
+    assert view.shape == (2, cpus)
+    rows = dict(zip(memoryview(keys).tolist(), view.tolist()))
+    assert rows == {1: list(range(cpus)), 2: [5] * cpus}
@@ -0,0 +1,67 @@
+import pytest
+from conftest import PERCPU_HASH, load_reshaped, requires_root, requires_testing
+
+import pylibbpf as m
+
+BPF_NOEXIST = 1
+
+pytestmark = requires_root
+
+
+def test_lookup_into(last_map):
+    last_map[1] = 0x1122334455
+    out = bytearray(8)
+    assert last_map.lookup_into(1, out)
+    assert int.from_bytes(out, "little") == 0x1122334455
+
+    # A missing key leaves the buffer alone
+    assert not last_map.lookup_into(2, out)
+    assert int.from_bytes(out, "little") == 0x1122334455
+
+
+def test_update_from(last_map):
+    last_map.update_from(3, (42).to_bytes(8, "little"))
+    assert last_map[3] == 42
+    last_map.update_from(3, memoryview(bytearray((43).to_bytes(8, "little"))))
+    assert last_map[3] == 43
+    with pytest.raises(m.BpfException, match="Failed to update"):
+        last_map.update_from(3, bytes(8), flags=BPF_NOEXIST)
+
+
+def test_rejects_wrong_sizes(last_map):
+    last_map[1] = 1
+    with pytest.raises(m.BpfException, match="needs 8"):
+        last_map.lookup_into(1, bytearray(4))
+    with pytest.raises(m.BpfException, match="needs 8"):
+        last_map.update_from(1, bytes(16))
+
+
+def test_lookup_into_needs_writable_buffer(last_map):
+    last_map[1] = 1
+    with pytest.raises(BufferError):
+        last_map.lookup_into(1, bytes(8))
+
+
+def test_repeated_access_reuses_scratch(last_map):
+    # lookup()/update() stage through one per-map arena; interleaving them
+    # must never leak one call's bytes into another
+    for key in range(16):
+        last_map[key] = key << 40
+    for key in range(16):
+        assert last_map[key] == key << 40
+
+
+@requires_testing
+def test_percpu_buffers_hold_every_cpu():
+    obj = load_reshaped(PERCPU_HASH, 4, 8, 8)
+    percpu_map = obj.get_map("last")
+    cpus = percpu_map.get_num_cpus()
+    values = b"".join(cpu.to_bytes(8, "little") for cpu in range(cpus))
+    percpu_map.update_from(1, values)
+    assert percpu_map[1] == list(range(cpus))
+
+    out = bytearray(8 * cpus)
+    assert percpu_map.lookup_into(1, out)
+    assert bytes(out) == values
+    with pytest.raises(m.BpfException):
+        percpu_map.lookup_into(1, bytearray(8 * cpus + 8))
@@ -0,0 +1,47 @@
+import pytest
+from conftest import requires_root
+
+import pylibbpf as m
+
+pytestmark = requires_root
+
+
+def fill(bpf_map):
+    for key in range(10):
+        bpf_map[key] = key * 3
+
+
+@pytest.mark.parametrize("chunk", [1, 3, 256])
+def test_iterators_match_dumps(last_map, chunk):
+    fill(last_map)
+    assert sorted(last_map.iter_keys(chunk)) == sorted(last_map.keys())
+    assert sorted(last_map.iter_values(chunk)) == sorted(last_map.values())
+    assert dict(last_map.iter_items(chunk)) == last_map.items()
+
+
+def test_iter_over_map(last_map):
+    fill(last_map)
+    assert sorted(last_map) == list(range(10))
+    assert sorted(key for key in last_map) == list(range(10))
+
+
+def test_iterator_is_lazy_and_single_pass(last_map):
+    fill(last_map)
+    it = last_map.iter_items(2)
+    assert iter(it) is it
+    first = next(it)
+    assert last_map[first[0]] == first[1]
+    rest = list(it)
+    assert len(rest) == 9
+    with pytest.raises(StopIteration):
+        next(it)
+
+
+def test_empty_map(last_map):
+    assert list(last_map.iter_items()) == []
+    assert list(last_map) == []
+
+
+def test_rejects_empty_chunks(last_map):
+    with pytest.raises(m.BpfException, match="chunk_size"):
+        last_map.iter_keys(0)
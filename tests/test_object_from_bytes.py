@@ -0,0 +1,71 @@
+import pytest
+from conftest import EXECVE_OBJ, requires_root
+
+import pylibbpf as m
+
+# Mirrors ObjectCache::kMaxEntries
+CACHE_MAX_ENTRIES = 64
+
+
+@pytest.fixture
+def image():
+    with open(EXECVE_OBJ, "rb") as f:
+        return f.read()
+
+
+@pytest.fixture(autouse=True)
+def empty_cache():
+    m.BpfObject.clear_cache()
+    yield
+    m.BpfObject.clear_cache()
+
+
+def test_open_from_bytes(image):
+    obj = m.BpfObject.from_bytes(image, name="execve")
+    obj.open()
+    assert obj.is_opened()
+    assert not obj.is_loaded()
+
+
+def test_errors_name_the_source():
+    with pytest.raises(m.BpfException, match="in-memory image: "):
+        m.BpfObject.from_bytes(b"not an ELF file").open()
+    with pytest.raises(m.BpfException, match="in-memory image 'junk'"):
+        m.BpfObject.from_bytes(b"not an ELF file", name="junk").open()
+    with pytest.raises(m.BpfException, match="file 'tests/no_such_object.o'"):
+        m.BpfObject("tests/no_such_object.o").open()
+
+
+def test_rejects_strided_buffers(image):
+    with pytest.raises(m.BpfException, match="contiguous"):
+        m.BpfObject.from_bytes(memoryview(image)[::2])
+
+
+def test_uncached_objects_skip_the_cache(image):
+    m.BpfObject.from_bytes(image).open()
+    assert m.BpfObject.get_cache_stats() == {"entries": 0, "hits": 0, "misses": 0}
+
+
+def test_cache_prepares_spares_for_reopened_images(image):
+    for _ in range(3):
+        m.BpfObject.from_bytes(image, cache=True).open()
+    # The first two opens parse inline; the second starts a spare that the
+    # third one takes
+    assert m.BpfObject.get_cache_stats() == {"entries": 1, "hits": 1, "misses": 2}
+
+    m.BpfObject.from_bytes(image, name="other", cache=True)
+    assert m.BpfObject.get_cache_stats()["entries"] == 2
+
+
+def test_cache_is_bounded():
+    for i in range(CACHE_MAX_ENTRIES + 8):
+        m.BpfObject.from_bytes(b"image", name=str(i), cache=True)
+    assert m.BpfObject.get_cache_stats()["entries"] == CACHE_MAX_ENTRIES
+
+
+@requires_root
+def test_load_cached_image(image):
+    objects = [m.BpfObject.from_bytes(image, cache=True) for _ in range(3)]
+    for obj in objects:
+        obj.load()
+        assert obj.get_map("last").get_name() == "last"
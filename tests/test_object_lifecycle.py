@@ -0,0 +1,88 @@
+import pytest
+from conftest import (
+    EXECVE_OBJ,
+    EXECVE_PROGRAMS,
+    LAST_MAP_SIZE,
+    load_object,
+    requires_root,
+)
+
+import pylibbpf as m
+
+# Built from tests/globals.ll: .rodata "threshold" (7) and .bss "hits"
+GLOBALS_OBJ = "tests/globals.o"
+
+
+def test_configure_needs_open():
+    obj = m.BpfObject(EXECVE_OBJ)
+    assert not obj.is_opened()
+    with pytest.raises(m.BpfException, match="call open"):
+        obj.set_max_entries("last", 8)
+    with pytest.raises(m.BpfException, match="not opened"):
+        obj.get_global("threshold")
+
+
+def test_open_without_loading():
+    obj = m.BpfObject(EXECVE_OBJ)
+    obj.open()
+    assert obj.is_opened()
+    assert not obj.is_loaded()
+    with pytest.raises(m.BpfException, match="already opened"):
+        obj.open()
+
+
+def test_configure_unknown_names():
+    obj = m.BpfObject(EXECVE_OBJ)
+    obj.open()
+    with pytest.raises(m.BpfException, match="Map 'nope' not found"):
+        obj.set_max_entries("nope", 8)
+    with pytest.raises(m.BpfException, match="Program 'nope' not found"):
+        obj.set_autoload("nope", False)
+
+
+def test_globals_before_load():
+    obj = m.BpfObject(GLOBALS_OBJ)
+    obj.open()
+    assert obj.get_global("threshold") == 7
+    assert obj.get_global("hits") == 0
+    obj.set_global("threshold", 3)
+    assert obj.get_global("threshold") == 3
+    with pytest.raises(m.BpfException, match="not found"):
+        obj.get_global("missing")
+
+
+@requires_root
+def test_load_opens_implicitly():
+    obj = m.BpfObject(EXECVE_OBJ)
+    obj.load()
+    assert obj.is_opened()
+    assert obj.is_loaded()
+    with pytest.raises(m.BpfException, match="already loaded"):
+        obj.load()
+
+
+@requires_root
+def test_resize_before_load():
+    obj = load_object(lambda obj: obj.set_max_entries("last", LAST_MAP_SIZE))
+    assert obj.get_map("last").get_max_entries() == LAST_MAP_SIZE
+    with pytest.raises(m.BpfException, match="after the BPF object is loaded"):
+        obj.set_max_entries("last", 1)
+
+
+@requires_root
+def test_autoload_off_skips_programs():
+    def disable(obj):
+        for name in EXECVE_PROGRAMS:
+            obj.set_autoload(name, False)
+
+    obj = load_object(disable)
+    with pytest.raises(m.BpfException):
+        obj.get_program("hello").attach()
+
+
+@requires_root
+def test_rodata_is_specialized_at_load():
+    obj = load_object(lambda obj: obj.set_global("threshold", 3), GLOBALS_OBJ)
+    assert obj.get_global("threshold") == 3
+    with pytest.raises(m.BpfException, match="after the BPF object is loaded"):
+        obj.set_global("threshold", 4)
@@ -0,0 +1,80 @@
+import pytest
+from conftest import (
+    PERCPU_ARRAY,
+    PERCPU_HASH,
+    load_reshaped,
+    requires_root,
+    requires_testing,
+)
+
+import pylibbpf as m
+
+pytestmark = [requires_root, requires_testing]
+
+
+@pytest.fixture(params=[PERCPU_HASH, PERCPU_ARRAY], ids=["hash", "array"])
+def percpu_map(request):
+    obj = load_reshaped(request.param, 4, 8, 8)
+    yield obj.get_map("last")
+
+
+def test_reports_cpus(percpu_map):
+    assert percpu_map.is_percpu()
+    assert percpu_map.get_num_cpus() >= 1
+
+
+def test_scalar_update_is_replicated(percpu_map):
+    cpus = percpu_map.get_num_cpus()
+    percpu_map[1] = 7
+    assert percpu_map[1] == [7] * cpus
+    assert percpu_map.lookup_reduce(1) == 7 * cpus
+    assert percpu_map.lookup_reduce(1, m.PercpuReduce.MIN) == 7
+    assert percpu_map.lookup_reduce(1, m.PercpuReduce.MAX) == 7
+
+
+def test_per_cpu_update(percpu_map):
+    cpus = percpu_map.get_num_cpus()
+    percpu_map[2] = list(range(cpus))
+    assert percpu_map[2] == list(range(cpus))
+    assert percpu_map.lookup_reduce(2) == sum(range(cpus))
+    assert percpu_map.lookup_reduce(2, m.PercpuReduce.MIN) == 0
+    assert percpu_map.lookup_reduce(2, m.PercpuReduce.MAX) == cpus - 1
+
+
+def test_rejects_wrong_cpu_count(percpu_map):
+    with pytest.raises(m.BpfException, match="per-CPU values"):
+        percpu_map[1] = [1] * (percpu_map.get_num_cpus() + 1)
+
+
+def test_items_reduce():
+    obj = load_reshaped(PERCPU_HASH, 4, 8, 8)
+    percpu_map = obj.get_map("last")
+    cpus = percpu_map.get_num_cpus()
+    for key in range(4):
+        percpu_map[key] = key
+    assert percpu_map.items() == {key: [key] * cpus for key in range(4)}
+    assert percpu_map.items_reduce(chunk_size=1) == {
+        key: key * cpus for key in range(4)
+    }
+    assert percpu_map.items_reduce(m.PercpuReduce.MAX) == {
+        key: key for key in range(4)
+    }
+    with pytest.raises(KeyError):
+        percpu_map.lookup_reduce(5)
+
+
+def test_reduce_needs_u64_slots():
+    obj = load_reshaped(PERCPU_HASH, 4, 4, 8)
+    percpu_map = obj.get_map("last")
+    percpu_map[1] = 3
+    assert percpu_map[1] == [3] * percpu_map.get_num_cpus()
+    with pytest.raises(m.BpfException, match="multiple of 8"):
+        percpu_map.lookup_reduce(1)
+
+
+def test_reduce_rejects_plain_maps(last_map):
+    assert not last_map.is_percpu()
+    with pytest.raises(m.BpfException, match="per-CPU"):
+        last_map.lookup_reduce(1)
+    with pytest.raises(m.BpfException, match="per-CPU"):
+        last_map.items_reduce()
@@ -0,0 +1,56 @@
+import gc
+
+import pytest
+from conftest import (
+    PERF_EVENT_ARRAY,
+    load_reshaped,
+    requires_root,
+    requires_testing,
+)
+
+import pylibbpf as m
+
+pytestmark = [requires_root, requires_testing]
+
+
+@pytest.fixture
+def perf_map():
+    # max_entries 0 lets libbpf size the array to the number of CPUs
+    obj = load_reshaped(PERF_EVENT_ARRAY, 4, 4, 0)
+    yield obj.get_map("last")
+
+
+def test_empty_snapshot(perf_map):
+    recorder = m.PerfFlightRecorder(perf_map, 1)
+    assert recorder.get_num_rings() > 0
+    assert recorder.get_map().get_name() == "last"
+    assert recorder.snapshot() == []
+
+
+def test_rejects_bad_page_count(perf_map):
+    with pytest.raises(m.BpfException):
+        m.PerfFlightRecorder(perf_map, 3)
+    # The failed constructor gives the map back
+    m.PerfFlightRecorder(perf_map, 1)
+
+
+def test_rejects_other_map_types(last_map):
+    with pytest.raises(m.BpfException):
+        m.PerfFlightRecorder(last_map, 1)
+
+
+def test_one_consumer_per_map(perf_map):
+    recorder = m.PerfFlightRecorder(perf_map, 1)
+    with pytest.raises(m.BpfException, match="perf consumer"):
+        m.PerfFlightRecorder(perf_map, 1)
+    with pytest.raises(m.BpfException, match="perf consumer"):
+        m.PerfEventArray(perf_map, 1, lambda cpu, data: None)
+
+    del recorder
+    gc.collect()
+    perf = m.PerfEventArray(perf_map, 1, lambda cpu, data: None)
+    with pytest.raises(m.BpfException, match="perf consumer"):
+        m.PerfFlightRecorder(perf_map, 1)
+    del perf
+    gc.collect()
+    m.PerfFlightRecorder(perf_map, 1)
@@ -0,0 +1,79 @@
+import threading
+
+import pytest
+from conftest import (
+    PAGE_SIZE,
+    RINGBUF,
+    load_reshaped,
+    requires_root,
+    requires_testing,
+)
+
+import pylibbpf as m
+
+
+def test_empty_poller():
+    poller = m.Poller()
+    assert len(poller) == 0
+    assert poller.epoll_fd() >= 0
+    with pytest.raises(m.BpfException):
+        poller.poll(0)
+
+
+def test_rejects_null_source():
+    with pytest.raises(m.BpfException):
+        m.Poller().add(None)
+
+
+@pytest.fixture
+def ring_map():
+    obj = load_reshaped(RINGBUF, 0, 0, 4 * PAGE_SIZE)
+    yield obj.get_map("last")
+
+
+@requires_root
+@requires_testing
+def test_add_and_remove(ring_map):
+    ring = m.RingBuffer(ring_map, lambda data: None)
+    poller = m.Poller()
+    poller.add(ring, priority=1, budget=8)
+    assert len(poller) == 1
+    with pytest.raises(m.BpfException):
+        poller.add(ring)
+
+    assert poller.poll(0) == 0
+
+    poller.remove(ring)
+    assert len(poller) == 0
+    with pytest.raises(m.BpfException):
+        poller.remove(ring)
+
+
+@requires_root
+@requires_testing
+def test_add_and_remove_while_polling(ring_map):
+    poller = m.Poller()
+    poller.add(m.RingBuffer(ring_map, lambda data: None))
+    errors = []
+    stop = threading.Event()
+
+    def poll_loop():
+        try:
+            while not stop.is_set():
+                assert poller.poll(1) >= 0
+        except Exception as exc:
+            errors.append(exc)
+
+    thread = threading.Thread(target=poll_loop)
+    thread.start()
+    try:
+        for _ in range(200):
+            ring = m.RingBuffer(ring_map, lambda data: None)
+            poller.add(ring, priority=1)
+            poller.remove(ring)
+    finally:
+        stop.set()
+        thread.join()
+
+    assert errors == []
+    assert len(poller) == 1
@@ -0,0 +1,62 @@
+import gc
+
+import pytest
+from conftest import (
+    ARRAY,
+    EXECVE_OBJ,
+    HASH,
+    LAST_MAP_SIZE,
+    load_object,
+    load_reshaped,
+    requires_root,
+    requires_testing,
+)
+
+import pylibbpf as m
+
+pytestmark = requires_root
+
+
+def reuse_last(source):
+    return lambda obj: obj.reuse_map("last", source)
+
+
+def test_objects_share_one_kernel_map(last_map):
+    last_map[1] = 11
+    obj = load_object(reuse_last(last_map))
+    shared = obj.get_map("last")
+    assert shared.get_fd() != last_map.get_fd()
+    # The source's definition wins, max_entries included
+    assert shared.get_max_entries() == LAST_MAP_SIZE
+
+    assert shared[1] == 11
+    shared[2] = 22
+    assert last_map[2] == 22
+
+
+def test_shared_map_outlives_its_source():
+    source_obj = load_object(lambda obj: obj.set_max_entries("last", 4))
+    source_obj.get_map("last")[3] = 33
+    obj = load_object(reuse_last(source_obj.get_map("last")))
+    del source_obj
+    gc.collect()
+    assert obj.get_map("last")[3] == 33
+
+
+@requires_testing
+@pytest.mark.parametrize(
+    "shape, error",
+    [((ARRAY, 4, 8, 4), "type 2 != 1"), ((HASH, 4, 4, 4), "value size 4 != 8")],
+)
+def test_rejects_incompatible_maps(shape, error):
+    source_obj = load_reshaped(*shape)
+    obj = m.BpfObject(EXECVE_OBJ)
+    obj.open()
+    with pytest.raises(m.BpfException, match=error):
+        obj.reuse_map("last", source_obj.get_map("last"))
+
+
+def test_reuse_after_load(last_map):
+    obj = load_object()
+    with pytest.raises(m.BpfException, match="after the BPF object is loaded"):
+        obj.reuse_map("last", last_map)